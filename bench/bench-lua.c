@@ -0,0 +1,231 @@
+/*
+ * Micro-benchmark for the Lua bindings
+ *
+ * Description
+ *
+ *	Embeds Lua, opens fixmath, fix_vec2 and fix_vec3 as globals, and times
+ *	one-line Lua snippets that each make one binding call.  Prints one CSV
+ *	line per snippet, so that runs can be diffed between releases:
+ *
+ *	binding,ns_per_op,mops,allocs_per_op,bytes_per_op
+ *
+ *	Allocations are counted by the lua_Alloc the state is created with, so
+ *	they are exact rather than sampled: every fix, vec2 and vec3 result is
+ *	one new userdata, and an allocation-free path shows 0.  Table and string
+ *	growth count the bytes added.  The collector runs as usual while timing,
+ *	so its cost is part of ns_per_op.
+ *
+ *	Every snippet runs inside the same numeric for loop; the "loop" line is
+ *	that loop on its own, and is included in every other line.  Each snippet
+ *	runs for about the given number of milliseconds (default 100), after one
+ *	calibration pass.  Build it against the Lua under test:
+ *
+ *	cc -O2 -I<lua include dir> -I. -o bench-lua bench/bench-lua.c \
+ *		math-sll.c lua_*.c -L<lua lib dir> -llua -lm
+ *	./bench-lua [ms_per_snippet] > before.csv
+ *
+ *	bench/Makefile builds it for every configuration, see there.
+ */
+
+/* clock_gettime() under -std=c99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "math-sll.h"
+
+LUALIB_API int luaopen_fixmath(lua_State *L);
+LUALIB_API int luaopen_fix_vec2(lua_State *L);
+LUALIB_API int luaopen_fix_vec3(lua_State *L);
+
+#define CALIBRATE	1000
+
+/*
+ * Locals every snippet can use.  Each snippet is compiled as the body of
+ *
+ *	for _ = 1, n do <snippet> end
+ */
+
+static const char prelude[] =
+	"local F, V2, V3 = fixmath, fix_vec2, fix_vec3\n"
+	"local R = F.raw\n"
+	"local a, b = F.tofix(1234.5, 1), F.tofix(-0.75, 2)\n"
+	"local v, w = V2.New(3, 4), V2.New(-1.5, 2.25, 2)\n"
+	"local p, q = V3.New(3, 4, 12), V3.New(-1.5, 2.25, 0.5, 2)\n"
+	"local u, s = V2.Clone(v), V3.Clone(p)\n"
+	"local ra, rb = F.rawvalue(a), F.rawvalue(b)\n";
+
+static const struct
+{
+	const char *name;
+	const char *snippet;
+} snippets[] = {
+	{"loop", ""},
+
+	{"fixmath.tofix", "local r = F.tofix(1.5, 1)"},
+	{"fixmath.parse", "local r = F.parse(\"1234.5678\")"},
+	{"fixmath.tostring", "local r = F.tostring(a)"},
+	{"fixmath.tonumber", "local r = F.tonumber(a)"},
+	{"fix.__add", "local r = a + b"},
+	{"fix.__sub", "local r = a - b"},
+	{"fix.__mul", "local r = a * b"},
+	{"fix.__mul[int]", "local r = a * 3"},
+	{"fix.__div", "local r = a / b"},
+	{"fix.__lt", "local r = a < b"},
+	{"fix.__eq", "local r = a == b"},
+	{"fixmath.sqrt", "local r = F.sqrt(a)"},
+	{"fixmath.sin", "local r = F.sin(b)"},
+	{"fixmath.sincos", "local r1, r2 = F.sincos(b)"},
+	{"fixmath.atan2", "local r = F.atan2(a, b)"},
+	{"fixmath.exp", "local r = F.exp(b)"},
+	{"fixmath.log", "local r = F.log(a)"},
+	{"fix.__pow", "local r = a ^ b"},
+#if LUA_VERSION_NUM >= 503
+	{"fixmath.raw.add", "local r = ra + rb"},
+	{"fixmath.raw.mul", "local r = R.mul(ra, rb)"},
+	{"fixmath.raw.div", "local r = R.div(ra, rb)"},
+	{"fixmath.raw.sqrt", "local r = R.sqrt(ra)"},
+	{"fixmath.raw.sin", "local r = R.sin(rb)"},
+#endif
+
+	{"fix_vec2.New", "local r = V2.New(3, 4)"},
+	{"fix_vec2.__add", "local r = v + w"},
+	{"fix_vec2.__mul", "local r = v * a"},
+	{"fix_vec2.Dot", "local r = V2.Dot(v, w)"},
+	{"fix_vec2.Cross", "local r = V2.Cross(v, w)"},
+	{"fix_vec2.Magnitude", "local r = V2.Magnitude(v)"},
+	{"fix_vec2.Distance", "local r = V2.Distance(v, w)"},
+	{"fix_vec2.Normalize", "local r = V2.Normalize(v)"},
+	{"fix_vec2.AddInPlace", "V2.AddInPlace(u, w)"},
+	{"fix_vec2:Dot", "local r = v:Dot(w)"},
+
+	{"fix_vec3.New", "local r = V3.New(3, 4, 12)"},
+	{"fix_vec3.__add", "local r = p + q"},
+	{"fix_vec3.__mul", "local r = p * a"},
+	{"fix_vec3.Dot", "local r = V3.Dot(p, q)"},
+	{"fix_vec3.Cross", "local r = V3.Cross(p, q)"},
+	{"fix_vec3.Magnitude", "local r = V3.Magnitude(p)"},
+	{"fix_vec3.Distance", "local r = V3.Distance(p, q)"},
+	{"fix_vec3.Normalize", "local r = V3.Normalize(p)"},
+	{"fix_vec3.AddInPlace", "V3.AddInPlace(s, q)"},
+	{"fix_vec3:Dot", "local r = p:Dot(q)"},
+};
+
+/*
+ * Counting allocator
+ */
+
+static unsigned long alloc_count;
+static unsigned long alloc_bytes;
+
+static void *count_alloc(void *ud, void *ptr, size_t osize, size_t nsize)
+{
+	(void) ud;
+
+	if (nsize == 0) {
+		free(ptr);
+		return NULL;
+	}
+	if (ptr == NULL) {
+		/* osize is the object type here, not a size */
+		alloc_count++;
+		alloc_bytes += nsize;
+	} else if (nsize > osize) {
+		alloc_bytes += nsize - osize;
+	}
+	return realloc(ptr, nsize);
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void fail(lua_State *L, const char *name)
+{
+	fprintf(stderr, "bench-lua: %s: %s\n", name, lua_tostring(L, -1));
+	exit(1);
+}
+
+static void open_module(lua_State *L, const char *name, lua_CFunction open)
+{
+	lua_pushcfunction(L, open);
+	lua_call(L, 0, 1);
+	lua_setglobal(L, name);
+}
+
+/*
+ * Calls the benchmark function on top of the stack with n, leaving it there
+ */
+
+static double run(lua_State *L, const char *name, long n)
+{
+	double t;
+
+	lua_pushvalue(L, -1);
+	lua_pushinteger(L, (lua_Integer) n);
+	t = now_ns();
+	if (lua_pcall(L, 1, 0, 0) != 0)
+		fail(L, name);
+	return now_ns() - t;
+}
+
+static void bench(lua_State *L, const char *name, const char *snippet,
+	double target_ns)
+{
+	char chunk[1024];
+	double t;
+	long n;
+
+	snprintf(chunk, sizeof(chunk),
+		"%sreturn function(n)\n\tfor _ = 1, n do %s end\nend\n",
+		prelude, snippet);
+	if (luaL_loadbuffer(L, chunk, strlen(chunk), name) != 0 ||
+		lua_pcall(L, 0, 1, 0) != 0)
+		fail(L, name);
+
+	t = run(L, name, CALIBRATE);
+	n = (long) (target_ns / (t > 1 ? t : 1) * CALIBRATE);
+	if (n < CALIBRATE)
+		n = CALIBRATE;
+
+	lua_gc(L, LUA_GCCOLLECT, 0);
+	alloc_count = 0;
+	alloc_bytes = 0;
+	t = run(L, name, n);
+	printf("%s,%.3f,%.3f,%.3f,%.3f\n", name, t / n, n * 1e3 / t,
+		(double) alloc_count / n, (double) alloc_bytes / n);
+
+	lua_pop(L, 1);
+}
+
+int main(int argc, char **argv)
+{
+	double target_ns = 100e6;
+	lua_State *L;
+	size_t i;
+
+	if (argc > 1)
+		target_ns = atof(argv[1]) * 1e6;
+
+	L = lua_newstate(count_alloc, NULL);
+	if (L == NULL)
+		return 1;
+	luaL_openlibs(L);
+	open_module(L, "fixmath", luaopen_fixmath);
+	open_module(L, "fix_vec2", luaopen_fix_vec2);
+	open_module(L, "fix_vec3", luaopen_fix_vec3);
+
+	printf("binding,ns_per_op,mops,allocs_per_op,bytes_per_op\n");
+	for (i = 0; i < sizeof(snippets) / sizeof(snippets[0]); i++)
+		bench(L, snippets[i].name, snippets[i].snippet, target_ns);
+
+	lua_close(L);
+	return 0;
+}
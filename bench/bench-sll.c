@@ -0,0 +1,467 @@
+/*
+ * Micro-benchmark for the math-sll kernels
+ *
+ * Description
+ *
+ *	Times each kernel over a fixed, seeded set of operands, and prints one
+ *	CSV line per kernel, so that runs can be diffed between releases:
+ *
+ *	kernel,operands,ns_per_op,mops
+ *
+ *	"operands" names the input distribution, picked to match what the kernel
+ *	sees in a game simulation:
+ *
+ *	coord		world coordinates, 2^-8 <= |x| < 2^16, log-uniform
+ *	divisor		2^-4 <= |y| < 2^12, log-uniform
+ *	positive	2^-16 <= x < 2^24, log-uniform
+ *	angle		-2 pi <= x < 2 pi, uniform
+ *	unit		-1 <= x < 1, uniform
+ *	exp		-16 <= x < 16, uniform, so e^x stays in range
+ *	base		2^-4 <= x < 2^4, log-uniform, with exponents in [-4, 4)
+ *	small		whole exponents, -8 <= n <= 8
+ *
+ *	Kernels are called through a function pointer, which adds the same small
+ *	constant to every line; inline kernels get a static wrapper for the same
+ *	reason.  Array kernels report the time per element.  Each kernel runs
+ *	for about the given number of milliseconds (default 100), after one
+ *	calibration pass.  Build it with the configuration under test, and run
+ *	it on an idle machine:
+ *
+ *	cc -O2 -I<lua include dir> -I. -o bench-sll bench/bench-sll.c math-sll.c
+ *	cc -O2 -I<lua include dir> -I. -DSLL_DIV_HARDWARE \
+ *		-o bench-sll-hw bench/bench-sll.c math-sll.c
+ *	./bench-sll [ms_per_kernel] > before.csv
+ *
+ *	or build and run every configuration with bench/Makefile:
+ *
+ *	make -C bench bench LUA_INC=<lua include dir> LUA_LIB=<-llua...> > before.csv
+ *
+ *	The *_exact lines always use the integer divide, so the first build
+ *	alone compares the Newton and hardware division paths.
+ */
+
+/* clock_gettime() under -std=c99 */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "math-sll.h"
+
+#define OPERANDS	4096
+
+typedef sll (*sll_fn1)(sll x);
+typedef sll (*sll_fn2)(sll x, sll y);
+typedef sll (*sll_fn3)(sll x, sll y, sll z);
+typedef sll (*sll_gen)(void);
+
+static sll xs[OPERANDS];
+static sll ys[OPERANDS];
+static sll zs[OPERANDS];
+
+static volatile sll sink;
+
+static double target_ns = 100e6;
+
+/*
+ * xorshift64, fixed seed so every run sees the same operands
+ */
+
+static ull rnd_state = 0x9e3779b97f4a7c15ULL;
+
+static ull rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return rnd_state;
+}
+
+/*
+ * Random sll with magnitude in [2^lo, 2^hi), log-uniform, random sign
+ */
+
+static sll rnd_sll(int lo, int hi)
+{
+	int e = lo + (int) (rnd() % (ull) (hi - lo));
+	sll v = (sll) (rnd() >> (64 - 32 - e)) | ((sll) 1 << (32 + e));
+
+	return (rnd() & 1) ? _sllneg(v): v;
+}
+
+/*
+ * Random sll in [lo, hi), uniform
+ */
+
+static sll rnd_range(sll lo, sll hi)
+{
+	return lo + (sll) (rnd() % (ull) (hi - lo));
+}
+
+/*
+ * Operand distributions
+ */
+
+static sll gen_coord(void)
+{
+	return rnd_sll(-8, 16);
+}
+
+static sll gen_divisor(void)
+{
+	return rnd_sll(-4, 12);
+}
+
+static sll gen_positive(void)
+{
+	sll x = rnd_sll(-16, 24);
+
+	return sllabs(x);
+}
+
+static sll gen_angle(void)
+{
+	return rnd_range(_sllneg(CONST_2PI), CONST_2PI);
+}
+
+static sll gen_unit(void)
+{
+	return rnd_range(_sllneg(CONST_1), CONST_1);
+}
+
+static sll gen_exp(void)
+{
+	return rnd_range(int2sll(-16), int2sll(16));
+}
+
+static sll gen_base(void)
+{
+	sll x = rnd_sll(-4, 4);
+
+	return sllabs(x);
+}
+
+static sll gen_exponent(void)
+{
+	return rnd_range(int2sll(-4), int2sll(4));
+}
+
+static sll gen_small(void)
+{
+	return int2sll((int) (rnd() % 17) - 8);
+}
+
+static void fill(sll *v, sll_gen gen)
+{
+	int i;
+
+	for (i = 0; i < OPERANDS; i++)
+		v[i] = gen();
+}
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report(const char *name, const char *operands, double ns, double ops)
+{
+	printf("%s,%s,%.3f,%.3f\n", name, operands, ns / ops, ops * 1e3 / ns);
+}
+
+/*
+ * Rounds needed to fill target_ns, from the time of one round
+ */
+
+static long rounds_for(double ns)
+{
+	double r = target_ns / (ns > 1 ? ns : 1);
+
+	return (r < 1) ? 1 : (long) r;
+}
+
+/*
+ * BENCH_ROUNDS runs ROUND, which covers all OPERANDS operands, once to
+ * calibrate and then for as many rounds as fill target_ns
+ */
+
+#define BENCH_ROUNDS(NAME, OPERANDS_NAME, ROUND) \
+	do { \
+		double t; \
+		long r, rounds; \
+		\
+		t = now_ns(); \
+		ROUND; \
+		rounds = rounds_for(now_ns() - t); \
+		t = now_ns(); \
+		for (r = 0; r < rounds; r++) \
+			ROUND; \
+		t = now_ns() - t; \
+		report(NAME, OPERANDS_NAME, t, (double) rounds * OPERANDS); \
+	} while (0)
+
+static void bench1(const char *name, const char *operands, sll_fn1 fn)
+{
+	sll acc = 0;
+	int i;
+
+	BENCH_ROUNDS(name, operands,
+		for (i = 0; i < OPERANDS; i++) acc += fn(xs[i]));
+	sink = acc;
+}
+
+static void bench2(const char *name, const char *operands, sll_fn2 fn)
+{
+	sll acc = 0;
+	int i;
+
+	BENCH_ROUNDS(name, operands,
+		for (i = 0; i < OPERANDS; i++) acc += fn(xs[i], ys[i]));
+	sink = acc;
+}
+
+static void bench3(const char *name, const char *operands, sll_fn3 fn)
+{
+	sll acc = 0;
+	int i;
+
+	BENCH_ROUNDS(name, operands,
+		for (i = 0; i < OPERANDS; i++) acc += fn(xs[i], ys[i], zs[i]));
+	sink = acc;
+}
+
+/*
+ * Wrappers, for inline kernels and for kernels of other shapes
+ */
+
+static sll div_fn(sll x, sll y)
+{
+	return slldiv(x, y);
+}
+
+static sll muli_fn(sll x, sll y)
+{
+	return sllmuli(x, sll2int(y));
+}
+
+static sll divi_fn(sll x, sll y)
+{
+	int n = sll2int(y);
+
+	return slldivi(x, n ? n : 1);
+}
+
+static sll sincos_fn(sll x)
+{
+	sll s, c;
+
+	sllsincos(x, &s, &c);
+	return s + c;
+}
+
+static sll sinh_fn(sll x)
+{
+	return sllsinh(x);
+}
+
+static sll cosh_fn(sll x)
+{
+	return sllcosh(x);
+}
+
+static sll tanh_fn(sll x)
+{
+	return slltanh(x);
+}
+
+static sll powi_fn(sll x, sll n)
+{
+	return sllpowi(x, sll2int(n));
+}
+
+static sll qmul16_fn(sll x, sll y)
+{
+	return sllqmul(x, y, 16);
+}
+
+static sll qdiv16_fn(sll x, sll y)
+{
+	return sllqdiv(x, y, 16);
+}
+
+static sll qsqrt16_fn(sll x)
+{
+	return sllqsqrt(x, 16);
+}
+
+static sll dot2_fn(sll x, sll y, sll z)
+{
+	return slldot2(x, y, y, z);
+}
+
+static sll dot3_fn(sll x, sll y, sll z)
+{
+	return slldot3(x, y, y, z, z, x);
+}
+
+static sll mag2_fn(sll x, sll y)
+{
+	return sllmag2(x, y);
+}
+
+static sll sll2dbl_fn(sll x)
+{
+	return (sll) sll2dbl(x);
+}
+
+static sll dbl2sll_fn(sll x)
+{
+	return dbl2sll((double) x * (1.0 / 4294967296.0));
+}
+
+static sll sll2str_fn(sll x)
+{
+	char buf[SLL_STR_MAX];
+
+	return sll2str(x, 6, buf) + buf[0];
+}
+
+/*
+ * Kernels over strings: the operands are formatted once, up front, with the
+ * 6 digits fixmath.tostring() gives
+ */
+
+static void bench_str2sll(void)
+{
+	static char strs[OPERANDS][SLL_STR_MAX];
+	sll acc = 0;
+	sll v;
+	int i;
+
+	for (i = 0; i < OPERANDS; i++)
+		sll2str(xs[i], 6, strs[i]);
+	BENCH_ROUNDS("str2sll", "coord",
+		for (i = 0; i < OPERANDS; i++) acc += str2sll(strs[i], &v) + v);
+	sink = acc;
+}
+
+/*
+ * Array kernels, per element: one call is one round
+ */
+
+static void bench_arrays(void)
+{
+	static sll buf[OPERANDS];
+	static double dbuf[OPERANDS];
+	static float fbuf[OPERANDS];
+	sll a = CONST_1_2;
+	int j;
+
+	for (j = 0; j < OPERANDS; j++)
+		buf[j] = xs[j];
+
+#define BENCH_ARRAY(NAME, CALL)	BENCH_ROUNDS(NAME, "coord", CALL)
+
+	BENCH_ARRAY("sllaxpy_array", sllaxpy_array(xs, a, buf, OPERANDS));
+	BENCH_ARRAY("slladd_array", slladd_array(xs, buf, OPERANDS));
+	BENCH_ARRAY("sllscale_array", sllscale_array(a, buf, OPERANDS));
+	BENCH_ARRAY("sllmul_array", sllmul_array(ys, buf, OPERANDS));
+	BENCH_ARRAY("slllerp_array", slllerp_array(xs, a, buf, OPERANDS));
+	BENCH_ARRAY("sllclamp_array", sllclamp_array(_sllneg(CONST_1), CONST_1, buf, OPERANDS));
+	BENCH_ARRAY("slldot_array", sink = slldot_array(xs, ys, OPERANDS));
+	BENCH_ARRAY("sll2dbl_array", sll2dbl_array(xs, dbuf, OPERANDS));
+	BENCH_ARRAY("dbl2sll_array", dbl2sll_array(dbuf, buf, OPERANDS));
+	BENCH_ARRAY("sll2flt_array", sll2flt_array(xs, fbuf, OPERANDS));
+
+#undef BENCH_ARRAY
+	sink = buf[OPERANDS - 1] + (sll) fbuf[0];
+}
+
+int main(int argc, char **argv)
+{
+	if (argc > 1)
+		target_ns = atof(argv[1]) * 1e6;
+
+	printf("kernel,operands,ns_per_op,mops\n");
+
+	fill(xs, gen_coord);
+	fill(ys, gen_coord);
+	fill(zs, gen_coord);
+	bench2("sllmul", "coord", sllmul);
+	bench2("sllmul_rn", "coord", sllmul_rn);
+	bench3("sllmla", "coord", sllmla);
+	bench3("slldot2", "coord", dot2_fn);
+	bench3("slldot3", "coord", dot3_fn);
+	bench2("sllmag2", "coord", mag2_fn);
+	bench3("sllmag3", "coord", sllmag3);
+	bench3("sllmagsq3", "coord", sllmagsq3);
+	bench2("sllqmul[16]", "coord", qmul16_fn);
+	bench1("sll2dbl", "coord", sll2dbl_fn);
+	bench1("dbl2sll", "coord", dbl2sll_fn);
+	bench1("sll2str", "coord", sll2str_fn);
+	bench_str2sll();
+	bench_arrays();
+
+	fill(ys, gen_divisor);
+#if defined(SLL_DIV_HARDWARE)
+	bench2("slldiv[hardware]", "divisor", div_fn);
+#else
+	bench2("slldiv[newton]", "divisor", div_fn);
+#endif
+	bench2("slldiv_exact", "divisor", slldiv_exact);
+	bench2("sllqdiv[16]", "divisor", qdiv16_fn);
+
+	fill(ys, gen_small);
+	bench2("sllmuli", "small", muli_fn);
+	bench2("slldivi", "small", divi_fn);
+
+	fill(xs, gen_divisor);
+#if defined(SLL_DIV_HARDWARE)
+	bench1("sllinv[hardware]", "divisor", sllinv);
+#else
+	bench1("sllinv[newton]", "divisor", sllinv);
+#endif
+	bench1("sllinv_exact", "divisor", sllinv_exact);
+
+	fill(xs, gen_positive);
+	bench1("sllsqrt", "positive", sllsqrt);
+	bench1("slld2dsqrt", "positive", slld2dsqrt);
+	bench1("sllrsqrt", "positive", sllrsqrt);
+	bench1("sllqsqrt[16]", "positive", qsqrt16_fn);
+	bench1("slllog", "positive", slllog);
+	bench1("slllog2", "positive", slllog2);
+
+	fill(xs, gen_angle);
+	bench1("sllsin", "angle", sllsin);
+	bench1("sllcos", "angle", sllcos);
+	bench1("slltan", "angle", slltan);
+	bench1("sllsincos", "angle", sincos_fn);
+
+	fill(xs, gen_unit);
+	bench1("sllasin", "unit", sllasin);
+	bench1("sllacos", "unit", sllacos);
+	bench1("sllatan", "unit", sllatan);
+
+	fill(xs, gen_coord);
+	fill(ys, gen_coord);
+	bench2("sllatan2", "coord", sllatan2);
+
+	fill(xs, gen_exp);
+	bench1("sllexp", "exp", sllexp);
+	bench1("sllexp2", "exp", sllexp2);
+	bench1("sllsinh", "exp", sinh_fn);
+	bench1("sllcosh", "exp", cosh_fn);
+	bench1("slltanh", "exp", tanh_fn);
+
+	fill(xs, gen_base);
+	fill(ys, gen_exponent);
+	bench2("sllpow", "base", sllpow);
+	fill(ys, gen_small);
+	bench2("sllpowi", "small", powi_fn);
+
+	return 0;
+}
@@ -0,0 +1,749 @@
+/*
+ * Reference checks for the math-sll kernels
+ *
+ * Description
+ *
+ *	Runs each kernel over fixed, seeded operands and hand-picked edge
+ *	cases, and compares it with a double (or exact integer) reference.
+ *	Prints one CSV line per check:
+ *
+ *	check,cases,failures,max_err_ulp
+ *
+ *	where max_err_ulp is the largest difference from the reference seen, in
+ *	units of the last place of the result format.  The first few failures
+ *	of each check go to stderr, and the exit status is 1 if any check
+ *	failed.  Covered:
+ *
+ *	sllatan2		against atan2(), at most 0.5 ulp
+ *	slldiv_exact, sllqdiv	truncated quotient, saturation and y = 0
+ *	sllpowi, sllpow		negative whole exponents, also for |x| < 1
+ *	str2sll, sll2str	exact round trips, and parsing against integers
+ *	q16, q48		conversions, rounding and saturation
+ *	slldot*			against double sums and against sllmul() sums
+ *	sllmagd*, sllmagsqd*	distances, also between far apart points
+ *	mat3, mat4		inverse * M = I, and singular matrices
+ *
+ *	The double references are only used where they are exact to well
+ *	below one ulp, so each bound is the documented one.  Build it with the
+ *	configuration under test, like bench-sll:
+ *
+ *	cc -O2 -I<lua include dir> -I. -o check-sll bench/check-sll.c \
+ *		math-sll.c lua_*.c -L<lua lib dir> -llua -lm
+ *	cc -O2 -I<lua include dir> -I. -DSLL_MUL_ROUND -o check-sll-rn \
+ *		bench/check-sll.c math-sll.c lua_*.c -L<lua lib dir> -llua -lm
+ *	./check-sll
+ *
+ *	or build and run every configuration with bench/Makefile:
+ *
+ *	make -C bench check LUA_INC=<lua include dir> LUA_LIB=<-llua...>
+ */
+
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "math-sll.h"
+#include "math-sll-q.h"
+
+#define CASES		100000
+#define SHOW_FAILURES	5
+
+/* 2^32, one sll ulp is 1 / ULP */
+#define ULP		4294967296.0
+
+/*
+ * xorshift64, fixed seed so every run sees the same operands
+ */
+
+static ull rnd_state = 0x9e3779b97f4a7c15ULL;
+
+static ull rnd(void)
+{
+	rnd_state ^= rnd_state << 13;
+	rnd_state ^= rnd_state >> 7;
+	rnd_state ^= rnd_state << 17;
+	return rnd_state;
+}
+
+/*
+ * Random sll with magnitude in [2^lo, 2^hi), log-uniform, random sign
+ */
+
+static sll rnd_sll(int lo, int hi)
+{
+	int e = lo + (int) (rnd() % (ull) (hi - lo));
+	sll v = (sll) (rnd() >> (64 - 32 - e)) | ((sll) 1 << (32 + e));
+
+	return (rnd() & 1) ? _sllneg(v): v;
+}
+
+/*
+ * Current check
+ */
+
+static const char *check_name;
+static long check_cases;
+static long check_failures;
+static double check_max_err;
+static int failed;
+
+static void begin(const char *name)
+{
+	check_name = name;
+	check_cases = 0;
+	check_failures = 0;
+	check_max_err = 0;
+}
+
+static void end(void)
+{
+	printf("%s,%ld,%ld,%.3f\n", check_name, check_cases, check_failures,
+		check_max_err);
+	if (check_failures)
+		failed = 1;
+}
+
+/*
+ * Records one case, err is the distance from the reference in ulp
+ */
+
+static void expect(int ok, double err, const char *fmt, ...)
+{
+	va_list ap;
+
+	check_cases++;
+	if (err > check_max_err)
+		check_max_err = err;
+	if (ok)
+		return;
+	if (check_failures++ < SHOW_FAILURES) {
+		fprintf(stderr, "check-sll: %s: ", check_name);
+		va_start(ap, fmt);
+		vfprintf(stderr, fmt, ap);
+		va_end(ap);
+		fputc('\n', stderr);
+	}
+}
+
+/*
+ * Expects got within bound ulp of ref, both in sll units
+ */
+
+static void expect_near(sll got, double ref, double bound, const char *what,
+	sll x, sll y)
+{
+	double err = fabs((double) got - ref);
+
+	expect(err <= bound, err, "%s(%lld, %lld) = %lld, expected %.3f",
+		what, (long long) x, (long long) y, (long long) got, ref);
+}
+
+static void expect_equal(sll got, sll want, const char *what, sll x, sll y)
+{
+	expect(got == want, (got == want) ? 0 : 1,
+		"%s(%lld, %lld) = %lld, expected %lld", what, (long long) x,
+		(long long) y, (long long) got, (long long) want);
+}
+
+/*
+ * sllatan2
+ *
+ *	Coordinates below 2^20 have at most 52 significant bits, so the
+ *	operands convert to double exactly, and atan2() is good to 2^-52 of pi,
+ *	far below one sll ulp.
+ */
+
+static void check_atan2(void)
+{
+	static const sll edge[] = {
+		CONST_0, CONST_1, -CONST_1, CONST_MAX, -CONST_MAX, 1, -1,
+		0x7fffffffLL, (sll) 1 << 40
+	};
+	int n = sizeof(edge) / sizeof(edge[0]);
+	sll x, y;
+	int i, j;
+
+	begin("sllatan2");
+
+	expect_equal(sllatan2(CONST_0, CONST_0), CONST_0, "sllatan2", 0, 0);
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < n; j++) {
+			y = edge[i];
+			x = edge[j];
+			if (x == CONST_0 && y == CONST_0)
+				continue;
+			expect_near(sllatan2(y, x),
+				atan2(sll2dbl(y), sll2dbl(x)) * ULP, 0.5 + 1e-3,
+				"sllatan2", y, x);
+		}
+	}
+
+	for (i = 0; i < CASES; i++) {
+		y = rnd_sll(-24, 20);
+		x = rnd_sll(-24, 20);
+		expect_near(sllatan2(y, x), atan2(sll2dbl(y), sll2dbl(x)) * ULP,
+			0.5 + 1e-3, "sllatan2", y, x);
+	}
+
+	end();
+}
+
+/*
+ * slldiv_exact, sllqdiv
+ *
+ *	The quotient is truncated, so it lies within one unit of the real
+ *	quotient, toward zero.  The double quotient of two 64 bit integers is
+ *	off by up to 2^-51 of itself, which is allowed for.
+ */
+
+static void check_qdiv_case(sll x, sll y, int f)
+{
+	double ref = ldexp((double) x / (double) y, f);
+	double lim = ldexp(1.0, 63);
+	double slack = fabs(ref) * ldexp(1.0, -50);
+	sll got = sllqdiv(x, y, f);
+	double err = fabs((double) got - ref) - slack;
+
+	/* Too close to the saturation threshold for a double to tell */
+	if (fabs(fabs(ref) - lim) <= slack + 1)
+		return;
+
+	if (fabs(ref) > lim) {
+		expect_equal(got, (ref < 0) ? CONST_MIN : CONST_MAX, "sllqdiv",
+			x, y);
+		return;
+	}
+	/* got is ref truncated toward zero */
+	expect(fabs((double) got) <= fabs(ref) + slack &&
+		fabs((double) got - ref) < 1 + slack &&
+		(got == 0 || (got < 0) == (ref < 0)),
+		(err > 0) ? err : 0,
+		"sllqdiv(%lld, %lld, %d) = %lld, expected %.3f", (long long) x,
+		(long long) y, f, (long long) got, ref);
+}
+
+static void check_div(void)
+{
+	static const int fs[] = { 0, 1, 16, 31, 32, 33, 48, 62, 63 };
+	sll x, y;
+	int i, j;
+
+	begin("slldiv_exact");
+
+	expect_equal(slldiv_exact(int2sll(7), int2sll(2)), 0x380000000LL,
+		"slldiv_exact", int2sll(7), int2sll(2));
+	expect_equal(slldiv_exact(CONST_1, int2sll(3)), 0x55555555LL,
+		"slldiv_exact", CONST_1, int2sll(3));
+	expect_equal(slldiv_exact(-CONST_1, int2sll(3)), -0x55555555LL,
+		"slldiv_exact", -CONST_1, int2sll(3));
+	expect_equal(slldiv_exact(CONST_1, -int2sll(3)), -0x55555555LL,
+		"slldiv_exact", CONST_1, -int2sll(3));
+
+	/* Division by zero and overflow saturate, 0 / y is 0 */
+	expect_equal(slldiv_exact(CONST_1, CONST_0), CONST_MAX,
+		"slldiv_exact", CONST_1, CONST_0);
+	expect_equal(slldiv_exact(-CONST_1, CONST_0), CONST_MIN,
+		"slldiv_exact", -CONST_1, CONST_0);
+	expect_equal(slldiv_exact(CONST_0, CONST_0), CONST_0,
+		"slldiv_exact", CONST_0, CONST_0);
+	expect_equal(slldiv_exact(CONST_MAX, CONST_1_2), CONST_MAX,
+		"slldiv_exact", CONST_MAX, CONST_1_2);
+	expect_equal(slldiv_exact(CONST_MAX, -CONST_1_2), CONST_MIN,
+		"slldiv_exact", CONST_MAX, -CONST_1_2);
+	expect_equal(slldiv_exact(CONST_MIN, CONST_1), CONST_MIN,
+		"slldiv_exact", CONST_MIN, CONST_1);
+	expect_equal(slldiv_exact(int2sll(1 << 20), 1), CONST_MAX,
+		"slldiv_exact", int2sll(1 << 20), 1);
+
+	for (i = 0; i < CASES; i++) {
+		x = rnd_sll(-24, 28);
+		y = rnd_sll(-24, 28);
+		check_qdiv_case(x, y, 32);
+	}
+
+	end();
+
+	begin("sllqdiv");
+
+	for (j = 0; j < (int) (sizeof(fs) / sizeof(fs[0])); j++) {
+		expect_equal(sllqdiv(1, 0, fs[j]), CONST_MAX, "sllqdiv", 1, 0);
+		expect_equal(sllqdiv(-1, 0, fs[j]), CONST_MIN, "sllqdiv", -1, 0);
+		for (i = 0; i < CASES / 10; i++) {
+			x = (sll) (rnd() >> (rnd() % 64));
+			y = (sll) (rnd() >> (rnd() % 64));
+			if (y == 0)
+				continue;
+			if (rnd() & 1)
+				x = _sllneg(x);
+			if (rnd() & 1)
+				y = _sllneg(y);
+			check_qdiv_case(x, y, fs[j]);
+		}
+	}
+
+	end();
+}
+
+/*
+ * sllpowi, sllpow with negative whole exponents
+ *
+ *	For |x| < 1, 1 / x is within one ulp, which becomes u * |x| * |x^n|
+ *	ulp of the result for the exponent -u.  The chop of each partial power
+ *	grows the same way, up to twice more, so the bound is 3u * |x| * |x^n|
+ *	ulp plus one per multiply.  |x| >= 1 stays within the same bound.
+ *	Results that reach 2^31 saturate.
+ */
+
+static void expect_powi(sll got, sll x, int n, const char *what)
+{
+	double ax = fabs(sll2dbl(x));
+	double ref = pow(sll2dbl(x), n) * ULP;
+	double u = -n;
+	double bound = 3 * u * ax * fabs(ref) / ULP + 2 * u + 1;
+	double err;
+
+	if (fabs(ref) >= ldexp(1.0, 63) * (1 - 1e-9)) {
+		if (fabs(ref) > ldexp(1.0, 63) * (1 + 1e-9))
+			expect_equal(got, (ref < 0) ? -CONST_MAX : CONST_MAX,
+				what, x, n);
+		return;
+	}
+	err = fabs((double) got - ref);
+	expect(err <= bound, err,
+		"%s(%.10f, %d) = %.6f, expected %.6f", what, sll2dbl(x), n,
+		sll2dbl(got), ref / ULP);
+}
+
+static void check_powi(void)
+{
+	static const double edge[] = {
+		0.0011906, -0.0011906, 0.5, -0.5, 0.3, 0.999, 1e-5, 1.5, -2.5, 1
+	};
+	sll x;
+	int i, n;
+
+	begin("sllpowi");
+
+	expect_equal(sllpowi(CONST_0, -1), CONST_MAX, "sllpowi", 0, -1);
+	for (i = 0; i < (int) (sizeof(edge) / sizeof(edge[0])); i++) {
+		for (n = -1; n >= -9; n--) {
+			x = dbl2sll(edge[i]);
+			expect_powi(sllpowi(x, n), x, n, "sllpowi");
+			expect_powi(sllpow(x, int2sll(n)), x, n, "sllpow");
+		}
+	}
+
+	for (i = 0; i < CASES; i++) {
+		x = (i & 1) ? rnd_sll(-12, 0) : rnd_sll(0, 8);
+		n = -1 - (int) (rnd() % 8);
+		expect_powi(sllpowi(x, n), x, n, "sllpowi");
+	}
+
+	end();
+}
+
+/*
+ * str2sll, sll2str
+ *
+ *	32 fractional digits hold any sll exactly, and 10 are enough to get
+ *	back the same sll, since 10^-10 / 2 is less than half an ulp.
+ */
+
+static void check_str(void)
+{
+	static const char *bad[] = {
+		"", " ", "-", ".", "e5", "1e", "abc", "2147483648", "-2147483649",
+		"1e10", "0x10"
+	};
+	static const struct {
+		const char *s;
+		sll v;
+	} good[] = {
+		{ "0", CONST_0 },
+		{ "-0", CONST_0 },
+		{ "1", CONST_1 },
+		{ "-1.5", -0x180000000LL },
+		{ "0.5e1", 0x500000000LL },
+		{ ".25", 0x40000000LL },
+		{ "2147483647.99999999988", CONST_MAX },
+		{ "0.000000000116415321826934814453125", 1 },
+		{ "-0.000000000116415321826934814453125", -1 },
+		{ "0.000000000116415321826934814453124", 0 },
+	};
+	char buf[SLL_STR_MAX];
+	char ref[64];
+	ull ip, f;
+	sll x, y;
+	int i, n;
+
+	begin("str2sll");
+
+	for (i = 0; i < (int) (sizeof(good) / sizeof(good[0])); i++) {
+		x = -1;
+		expect(str2sll(good[i].s, &x) == (int) strlen(good[i].s) &&
+			x == good[i].v, 0, "str2sll(\"%s\") = %lld, expected %lld",
+			good[i].s, (long long) x, (long long) good[i].v);
+	}
+	for (i = 0; i < (int) (sizeof(bad) / sizeof(bad[0])); i++) {
+		/* A prefix may parse, but never the whole string */
+		n = str2sll(bad[i], &x);
+		expect(n == 0 || n != (int) strlen(bad[i]), 0,
+			"str2sll(\"%s\") accepted", bad[i]);
+	}
+
+	/* ip.f with 9 digits is ip * 2^32 + f * 2^32 / 10^9, ties away */
+	for (i = 0; i < CASES; i++) {
+		ip = rnd() >> (33 + rnd() % 31);
+		f = rnd() % 1000000000ULL;
+		snprintf(ref, sizeof(ref), "%s%llu.%09llu", (rnd() & 1) ? "-" : "",
+			(unsigned long long) ip, (unsigned long long) f);
+		y = (sll) ((ip << 32) + ((f << 32) + 500000000ULL) / 1000000000ULL);
+		if (ref[0] == '-')
+			y = _sllneg(y);
+		x = 0;
+		n = str2sll(ref, &x);
+		expect(n == (int) strlen(ref) && x == y, 0,
+			"str2sll(\"%s\") = %lld, expected %lld", ref, (long long) x,
+			(long long) y);
+	}
+
+	end();
+
+	begin("sll2str");
+
+	for (i = 0; i < CASES; i++) {
+		x = (i & 1) ? rnd_sll(-31, 31) : (sll) rnd();
+		y = ~x;
+		sll2str(x, 32, buf);
+		expect(str2sll(buf, &y) == (int) strlen(buf) && y == x, 0,
+			"\"%s\" from %lld reads back as %lld", buf, (long long) x,
+			(long long) y);
+		y = ~x;
+		sll2str(x, 10, buf);
+		expect(str2sll(buf, &y) == (int) strlen(buf) && y == x, 0,
+			"\"%s\" from %lld reads back as %lld", buf, (long long) x,
+			(long long) y);
+	}
+
+	/* Fixed digits, trimmed digits, rounding and the sign of zero */
+	sll2str(0x180000000LL, 6, buf);
+	expect(strcmp(buf, "1.500000") == 0, 0, "1.5 -> \"%s\"", buf);
+	sll2str(0x180000000LL, -6, buf);
+	expect(strcmp(buf, "1.5") == 0, 0, "1.5 -> \"%s\"", buf);
+	sll2str(int2sll(3), -6, buf);
+	expect(strcmp(buf, "3.0") == 0, 0, "3 -> \"%s\"", buf);
+	sll2str(int2sll(3), 0, buf);
+	expect(strcmp(buf, "3") == 0, 0, "3 -> \"%s\"", buf);
+	sll2str(-1, 6, buf);
+	expect(strcmp(buf, "0.000000") == 0, 0, "-2^-32 -> \"%s\"", buf);
+	sll2str(CONST_MIN, 0, buf);
+	expect(strcmp(buf, "-2147483648") == 0, 0, "CONST_MIN -> \"%s\"", buf);
+	sll2str(CONST_MAX, 3, buf);
+	expect(strcmp(buf, "2147483648.000") == 0, 0, "CONST_MAX -> \"%s\"",
+		buf);
+
+	end();
+}
+
+/*
+ * q16, q48 conversions
+ *
+ *	q16 values are below 2^52 in units of 2^-32, so their double
+ *	references are exact; the q48 rounding is checked on the integers.
+ *	Rounding is to nearest, ties up.
+ */
+
+static double clamp(double v, double lo, double hi)
+{
+	return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+static void check_q(void)
+{
+	sll x, want;
+	q16 a;
+	q48 b;
+	int i;
+
+	begin("q16");
+
+	expect(int2q16(32767) == 0x7fff0000, 0, "int2q16(32767)");
+	expect(int2q16(32768) == Q16_MAX, 0, "int2q16(32768) not saturated");
+	expect(int2q16(-32768) == Q16_MIN, 0, "int2q16(-32768)");
+	expect(int2q16(-40000) == Q16_MIN, 0, "int2q16(-40000) not saturated");
+	expect(sll2q16(0x8000) == 1, 0, "sll2q16(2^-17) tie not rounded up");
+	expect(sll2q16(-0x8000) == 0, 0, "sll2q16(-2^-17) tie not rounded up");
+
+	for (i = 0; i < CASES; i++) {
+		x = rnd_sll(-24, 17);
+		want = (sll) clamp(floor(sll2dbl(x) * 65536 + 0.5),
+			Q16_MIN, Q16_MAX);
+		a = sll2q16(x);
+		expect(a == want, fabs((double) a - (double) want),
+			"sll2q16(%lld) = %ld, expected %lld", (long long) x,
+			(long) a, (long long) want);
+		expect(q162sll(a) == (sll) a * 65536, 0, "q162sll(%ld)", (long) a);
+		expect(q162q48(a) == (q48) a, 0, "q162q48(%ld)", (long) a);
+		expect(q162int(a) == (int) floor(q162dbl(a)), 0, "q162int(%ld)",
+			(long) a);
+		expect(dbl2q16(sll2dbl(x)) == a, 0, "dbl2q16(%.10f)",
+			sll2dbl(x));
+	}
+
+	end();
+
+	begin("q48");
+
+	for (i = 0; i < CASES; i++) {
+		x = rnd_sll(-31, 31);
+		b = sll2q48(x);
+		want = (x >> 16) + ((x >> 15) & 1);
+		expect(b == want, fabs((double) b - (double) want),
+			"sll2q48(%lld) = %lld, expected %lld", (long long) x,
+			(long long) b, (long long) want);
+		if (b < ((q48) 1 << 47) && b >= -((q48) 1 << 47))
+			expect(q482sll(b) == b * 65536, 0, "q482sll(%lld)",
+				(long long) b);
+		expect(q482q16(b) == (q16) clamp((double) b, Q16_MIN, Q16_MAX),
+			0, "q482q16(%lld)", (long long) b);
+		expect(q482int(b) == (sll) floor((double) b / 65536), 0,
+			"q482int(%lld)", (long long) b);
+	}
+
+	/* Out of the sll range */
+	b = (q48) 1 << 50;
+	expect(q482sll(b) == CONST_MAX, 0, "q482sll(2^34) not saturated");
+	expect(q482sll(-b) == (sll) CONST_MIN, 0, "q482sll(-2^34) not saturated");
+	expect(int2q48((sll) 1 << 40) == (q48) 1 << 56, 0, "int2q48(2^40)");
+
+	end();
+}
+
+/*
+ * slldot2, slldot3, slldot4, slldot_array
+ *
+ *	Operands below 2^4 make products below 2^8, whose double sum is good
+ *	to about 2^-44, so the reference is within 1/256 ulp.  A single chop
+ *	is at most one ulp off; a sum of sllmul() is up to one ulp per term.
+ *	slldot_array() is the sllmul() sum, bit for bit, SIMD or not.
+ */
+
+static double dot_ref(const sll *x, const sll *y, int n)
+{
+	double s = 0;
+	int i;
+
+	for (i = 0; i < n; i++)
+		s += sll2dbl(x[i]) * sll2dbl(y[i]);
+	return s * ULP;
+}
+
+static sll dot_naive(const sll *x, const sll *y, int n)
+{
+	sll s = CONST_0;
+	int i;
+
+	for (i = 0; i < n; i++)
+		s = slladd(s, sllmul(x[i], y[i]));
+	return s;
+}
+
+static void expect_dot(sll got, const sll *x, const sll *y, int n)
+{
+	double ref = dot_ref(x, y, n);
+	double err = fabs((double) got - ref);
+	sll naive = dot_naive(x, y, n);
+
+	expect(err <= 1 + 1.0 / 256, err, "slldot%d = %lld, expected %.3f", n,
+		(long long) got, ref);
+	expect(got - naive <= n && naive - got <= n, 0,
+		"slldot%d = %lld, sllmul sum %lld", n, (long long) got,
+		(long long) naive);
+}
+
+static void check_dot(void)
+{
+	sll x[64], y[64];
+	int i, j;
+
+	begin("slldot");
+
+	for (i = 0; i < CASES; i++) {
+		for (j = 0; j < 4; j++) {
+			x[j] = rnd_sll(-24, 4);
+			y[j] = rnd_sll(-24, 4);
+		}
+		expect_dot(slldot2(x[0], y[0], x[1], y[1]), x, y, 2);
+		expect_dot(slldot3(x[0], y[0], x[1], y[1], x[2], y[2]), x, y, 3);
+		expect_dot(slldot4(x[0], y[0], x[1], y[1], x[2], y[2], x[3],
+			y[3]), x, y, 4);
+	}
+
+	/* Cancellation that every sllmul() chop gets wrong */
+	x[0] = 1;
+	y[0] = 0x80000000LL;
+	x[1] = 1;
+	y[1] = 0x80000000LL;
+	expect_equal(slldot2(x[0], y[0], x[1], y[1]), 1, "slldot2", 1,
+		0x80000000LL);
+
+	end();
+
+	begin("slldot_array");
+
+	for (i = 0; i < CASES / 100; i++) {
+		for (j = 0; j < 64; j++) {
+			x[j] = rnd_sll(-24, 4);
+			y[j] = rnd_sll(-24, 4);
+		}
+		j = 1 + (int) (rnd() % 64);
+		expect_equal(slldot_array(x, y, j), dot_naive(x, y, j),
+			"slldot_array", j, 0);
+	}
+
+	end();
+}
+
+/*
+ * sllmagd2, sllmagd3, sllmagsqd2, sllmagsqd3
+ *
+ *	Where a - b fits they equal sllmag*() and sllmagsq*() of the
+ *	differences.  Points 2^31 or more apart saturate, where a - b in sll
+ *	would wrap to a short distance.
+ */
+
+static void check_magd(void)
+{
+	sll a[3], b[3], d[3];
+	int i, j;
+
+	begin("sllmagd");
+
+	for (i = 0; i < CASES; i++) {
+		for (j = 0; j < 3; j++) {
+			a[j] = rnd_sll(-24, 29);
+			b[j] = rnd_sll(-24, 29);
+			d[j] = a[j] - b[j];
+		}
+		expect_equal(sllmagd2(a[0], b[0], a[1], b[1]),
+			sllmag2(d[0], d[1]), "sllmagd2", a[0], b[0]);
+		expect_equal(sllmagd3(a[0], b[0], a[1], b[1], a[2], b[2]),
+			sllmag3(d[0], d[1], d[2]), "sllmagd3", a[0], b[0]);
+		expect_equal(sllmagsqd2(a[0], b[0], a[1], b[1]),
+			sllmagsq2(d[0], d[1]), "sllmagsqd2", a[0], b[0]);
+		expect_equal(sllmagsqd3(a[0], b[0], a[1], b[1], a[2], b[2]),
+			sllmagsq3(d[0], d[1], d[2]), "sllmagsqd3", a[0], b[0]);
+	}
+
+	expect_equal(sllmagd2(CONST_MAX, CONST_MIN, 0, 0), CONST_MAX,
+		"sllmagd2", CONST_MAX, CONST_MIN);
+	expect_equal(sllmagd3(0, 0, CONST_MIN, CONST_MAX, 0, 0), CONST_MAX,
+		"sllmagd3", CONST_MIN, CONST_MAX);
+	expect_equal(sllmagd2(int2sll(1 << 30), -int2sll(1 << 30), 0, 0),
+		CONST_MAX, "sllmagd2", int2sll(1 << 30), -int2sll(1 << 30));
+	expect_equal(sllmagsqd2(0, 0, CONST_MAX, -CONST_1), CONST_MAX,
+		"sllmagsqd2", CONST_MAX, -CONST_1);
+	expect_equal(sllmagsqd3(0, 0, 0, 0, int2sll(-3), int2sll(1)),
+		int2sll(16), "sllmagsqd3", int2sll(-3), int2sll(1));
+
+	end();
+}
+
+/*
+ * mat3_inverse, mat4_inverse
+ *
+ *	Random entries in [-1, 1) with 4 added on the diagonal keep the
+ *	matrices well conditioned, with det around 4^n.  slldiv() multiplies by
+ *	1 / det, which keeps only 32 - 2n significant bits, so inverse * M is I
+ *	to within about 2^-23 for mat4; SLL_DIV_HARDWARE does much better.
+ */
+
+#define MAT_TOL		(1.0 / (1 << 21))
+
+static void check_mat(void)
+{
+	Matrix3 a3, b3, p3;
+	Matrix4 a4, b4, p4;
+	double err, worst;
+	int i, j, k;
+
+	begin("mat3_inverse");
+
+	for (i = 0; i < CASES / 100; i++) {
+		for (j = 0; j < 3; j++) {
+			for (k = 0; k < 3; k++) {
+				a3.m[j][k] = (sll) (rnd() >> 31) - CONST_1;
+				if (j == k)
+					a3.m[j][k] += int2sll(4);
+			}
+		}
+		expect(mat3_inverse(&a3, &b3), 0, "mat3_inverse failed");
+		mat3_mul(&b3, &a3, &p3);
+		worst = 0;
+		for (j = 0; j < 3; j++) {
+			for (k = 0; k < 3; k++) {
+				err = fabs(sll2dbl(p3.m[j][k]) - (j == k));
+				if (err > worst)
+					worst = err;
+			}
+		}
+		expect(worst <= MAT_TOL, worst * ULP,
+			"inverse * M is %g away from I", worst);
+	}
+
+	/* Two equal rows, their cross product is exactly zero */
+	a3.m[2][0] = a3.m[1][0];
+	a3.m[2][1] = a3.m[1][1];
+	a3.m[2][2] = a3.m[1][2];
+	expect(!mat3_inverse(&a3, &b3), 0, "singular matrix inverted");
+
+	end();
+
+	begin("mat4_inverse");
+
+	for (i = 0; i < CASES / 100; i++) {
+		for (j = 0; j < 4; j++) {
+			for (k = 0; k < 4; k++) {
+				a4.m[j][k] = (sll) (rnd() >> 31) - CONST_1;
+				if (j == k)
+					a4.m[j][k] += int2sll(4);
+			}
+		}
+		expect(mat4_inverse(&a4, &b4), 0, "mat4_inverse failed");
+		mat4_mul(&b4, &a4, &p4);
+		worst = 0;
+		for (j = 0; j < 4; j++) {
+			for (k = 0; k < 4; k++) {
+				err = fabs(sll2dbl(p4.m[j][k]) - (j == k));
+				if (err > worst)
+					worst = err;
+			}
+		}
+		expect(worst <= MAT_TOL, worst * ULP,
+			"inverse * M is %g away from I", worst);
+	}
+
+	/* Two equal rows in the same half, their 2x2 minors are exactly zero */
+	for (k = 0; k < 4; k++)
+		a4.m[1][k] = a4.m[0][k];
+	expect(!mat4_inverse(&a4, &b4), 0, "singular matrix inverted");
+
+	end();
+}
+
+int main(void)
+{
+	printf("check,cases,failures,max_err_ulp\n");
+
+	check_atan2();
+	check_div();
+	check_powi();
+	check_str();
+	check_q();
+	check_dot();
+	check_magd();
+	check_mat();
+
+	return failed;
+}
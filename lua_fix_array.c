@@ -0,0 +1,214 @@
+#include "math-sll.h"
+#include <limits.h>
+#include <string.h>
+
+// 数据紧跟在 FixArray 后面, 一次分配
+FixArray *push_FixArray(lua_State *L, int n)
+{
+	FixArray* p = lua_newuserdata(L, sizeof(FixArray) + (size_t)n * sizeof(sll));
+	p->n = n;
+	p->v = (sll *)(p + 1);
+	memset(p->v, 0, (size_t)n * sizeof(sll));
+	luaL_getmetatable(L, __FIX_ARRAY_META__);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// 同 push_FixArray, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+FixArray *push_FixArray_up(lua_State *L, int n)
+{
+	FixArray* p = lua_newuserdata(L, sizeof(FixArray) + (size_t)n * sizeof(sll));
+	p->n = n;
+	p->v = (sll *)(p + 1);
+	memset(p->v, 0, (size_t)n * sizeof(sll));
+	fix_push_meta_up(L, FIX_META_FIX_ARRAY);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// Lua 下标从 1 开始, 返回 C 下标
+static int check_index(lua_State *L, int idx, int n)
+{
+	lua_Integer i = luaL_checkinteger(L, idx);
+	luaL_argcheck(L, i >= 1 && i <= n, idx, "下标越界");
+	return (int)(i - 1);
+}
+
+static int New(lua_State *L)
+{
+	lua_Integer n = luaL_checkinteger(L, 1);
+	luaL_argcheck(L, n >= 0 && n <= (lua_Integer)(INT_MAX / sizeof(sll)) - 1, 1, "长度不对");
+	push_FixArray_up(L, (int)n);
+	return 1;
+}
+
+static int Size(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	lua_pushinteger(L, self->n);
+	return 1;
+}
+
+static int Get(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	int i = check_index(L, 2, self->n);
+	push_fix_up(L, self->v[i]);
+	return 1;
+}
+
+static int Set(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	int i = check_index(L, 2, self->n);
+	check_set_fix(3, v);
+	self->v[i] = *v;
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int Fill(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix(2, v);
+	for (int i = 0; i < self->n; i++)
+	{
+		self->v[i] = *v;
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] + b[i]
+static int Add(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix_array(2, b);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	slladd_array(b->v, self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] * b[i]
+static int Mul(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix_array(2, b);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	sllmul_array(b->v, self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] * s
+static int Scale(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix(2, s);
+	sllscale_array(*s, self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] + b[i] * s
+static int Axpy(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix_array(2, b);
+	check_set_fix(3, s);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	sllaxpy_array(b->v, *s, self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = Lerp(self[i], b[i], t), t 限制在 [0, 1]
+static int Lerp(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix_array(2, b);
+	check_set_fix(3, t);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	slllerp_array(b->v, clamp_fix(*t, CONST_0, CONST_1), self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int Clamp(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix(2, lo);
+	check_set_fix(3, hi);
+	sllclamp_array(*lo, *hi, self->v, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int Dot(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	check_set_fix_array(2, b);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	push_fix_up(L, slldot_array(self->v, b->v, self->n));
+	return 1;
+}
+
+// 转成 Lua number 的 table, 调试或导出用
+static int ToTable(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	lua_createtable(L, self->n, 0);
+	for (int i = 0; i < self->n; i++)
+	{
+		lua_pushnumber(L, sll2dbl(self->v[i]));
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
+static int fix_array_tostring(lua_State *L)
+{
+	check_set_fix_array(1, self);
+	lua_pushfstring(L, "fix_array(%d)", self->n);
+	return 1;
+}
+
+const luaL_Reg lua_fix_array_meta_methods[] = {
+	{"__len",   Size},
+	{"__tostring",   fix_array_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_fix_array_modules[] = {
+	{"New",   New},
+	{"Size",   Size},
+	{"Get",   Get},
+	{"Set",   Set},
+	{"Fill",   Fill},
+	{"Add",   Add},
+	{"Mul",   Mul},
+	{"Scale",   Scale},
+	{"Axpy",   Axpy},
+	{"Lerp",   Lerp},
+	{"Clamp",   Clamp},
+	{"Dot",   Dot},
+	{"ToTable",   ToTable},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_array(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_array", lua_fix_array_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_fix_array_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_fix_array_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
@@ -0,0 +1,396 @@
+#include "math-sll.h"
+#include <string.h>
+
+/*
+	fix_mat3: 3x3 定点矩阵, 按行存, 作用在列向量上 (p' = M * p)
+	Get/Set 的行列下标和 Lua 一样从 1 开始
+*/
+
+Matrix3 *push_Matrix3(lua_State *L)
+{
+	Matrix3* p = lua_newuserdata(L, sizeof(Matrix3));
+	luaL_getmetatable(L, __MATRIX3_META__);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// 同 push_Matrix3, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+Matrix3 *push_Matrix3_up(lua_State *L)
+{
+	Matrix3* p = lua_newuserdata(L, sizeof(Matrix3));
+	fix_push_meta_up(L, FIX_META_MAT3);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+static void mat3_row(Matrix3 *self, int i, Vector3 *out)
+{
+	out->x = self->m[i][0];
+	out->y = self->m[i][1];
+	out->z = self->m[i][2];
+}
+
+static void mat3_set_row(Matrix3 *self, int i, Vector3 *v)
+{
+	self->m[i][0] = v->x;
+	self->m[i][1] = v->y;
+	self->m[i][2] = v->z;
+}
+
+static void mat3_identity(Matrix3 *self)
+{
+	memset(self, 0, sizeof(Matrix3));
+	self->m[0][0] = CONST_1;
+	self->m[1][1] = CONST_1;
+	self->m[2][2] = CONST_1;
+}
+
+// out = a * b, out 可以就是 a 或 b
+void mat3_mul(Matrix3 *a, Matrix3 *b, Matrix3 *out)
+{
+	Matrix3 ret;
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			ret.m[i][j] = slldot3(a->m[i][0], b->m[0][j], a->m[i][1], b->m[1][j],
+				a->m[i][2], b->m[2][j]);
+		}
+	}
+	*out = ret;
+}
+
+// out = self * a, out 可以就是 a
+void mat3_mul_vec3(Matrix3 *self, Vector3 *a, Vector3 *out)
+{
+	Vector3 r0, r1, r2;
+	mat3_row(self, 0, &r0);
+	mat3_row(self, 1, &r1);
+	mat3_row(self, 2, &r2);
+	sll x = vec3_dot(&r0, a);
+	sll y = vec3_dot(&r1, a);
+	sll z = vec3_dot(&r2, a);
+	out->x = x;
+	out->y = y;
+	out->z = z;
+}
+
+// 单位四元数 -> 旋转矩阵
+void mat3_from_rot4(Vector4 *q, Matrix3 *out)
+{
+	sll x2 = sllmul2(q->x), y2 = sllmul2(q->y), z2 = sllmul2(q->z);
+	sll xx = sllmul(q->x, x2), yy = sllmul(q->y, y2), zz = sllmul(q->z, z2);
+	sll xy = sllmul(q->x, y2), xz = sllmul(q->x, z2), yz = sllmul(q->y, z2);
+	sll wx = sllmul(q->w, x2), wy = sllmul(q->w, y2), wz = sllmul(q->w, z2);
+	out->m[0][0] = sllsub(CONST_1, slladd(yy, zz));
+	out->m[0][1] = sllsub(xy, wz);
+	out->m[0][2] = slladd(xz, wy);
+	out->m[1][0] = slladd(xy, wz);
+	out->m[1][1] = sllsub(CONST_1, slladd(xx, zz));
+	out->m[1][2] = sllsub(yz, wx);
+	out->m[2][0] = sllsub(xz, wy);
+	out->m[2][1] = slladd(yz, wx);
+	out->m[2][2] = sllsub(CONST_1, slladd(xx, yy));
+}
+
+static sll mat3_determinant(Matrix3 *self)
+{
+	Vector3 r0, r1, r2, c;
+	mat3_row(self, 0, &r0);
+	mat3_row(self, 1, &r1);
+	mat3_row(self, 2, &r2);
+	vec3_cross(&r1, &r2, &c);
+	return vec3_dot(&r0, &c);
+}
+
+// 行列下标从 1 开始, 返回 C 下标
+static int check_index(lua_State *L, int idx)
+{
+	lua_Integer i = luaL_checkinteger(L, idx);
+	luaL_argcheck(L, i >= 1 && i <= 3, idx, "下标越界");
+	return (int)(i - 1);
+}
+
+// 9 个定点数, 按行给出
+static int New(lua_State *L)
+{
+	Matrix3 m;
+	for (int i = 0; i < 9; i++)
+	{
+		check_set_fix(i + 1, v);
+		m.m[i / 3][i % 3] = *v;
+	}
+	*push_Matrix3_up(L) = m;
+	return 1;
+}
+
+static int Identity(lua_State *L)
+{
+	mat3_identity(push_Matrix3_up(L));
+	return 1;
+}
+
+static int FromRows(lua_State *L)
+{
+	check_set_vec3(1, r0);
+	check_set_vec3(2, r1);
+	check_set_vec3(3, r2);
+	Matrix3 *p = push_Matrix3_up(L);
+	mat3_set_row(p, 0, r0);
+	mat3_set_row(p, 1, r1);
+	mat3_set_row(p, 2, r2);
+	return 1;
+}
+
+static int FromRotation(lua_State *L)
+{
+	check_set_rot4(1, q);
+	mat3_from_rot4(q, push_Matrix3_up(L));
+	return 1;
+}
+
+static int FromScale(lua_State *L)
+{
+	check_set_vec3(1, s);
+	Matrix3 *p = push_Matrix3_up(L);
+	mat3_identity(p);
+	p->m[0][0] = s->x;
+	p->m[1][1] = s->y;
+	p->m[2][2] = s->z;
+	return 1;
+}
+
+static int Get(lua_State *L)
+{
+	check_set_mat3(1, self);
+	int i = check_index(L, 2);
+	int j = check_index(L, 3);
+	push_fix_up(L, self->m[i][j]);
+	return 1;
+}
+
+static int Set(lua_State *L)
+{
+	check_set_mat3(1, self);
+	int i = check_index(L, 2);
+	int j = check_index(L, 3);
+	check_set_fix(4, v);
+	self->m[i][j] = *v;
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int GetRow(lua_State *L)
+{
+	check_set_mat3(1, self);
+	int i = check_index(L, 2);
+	push_Vector3_up(L, self->m[i][0], self->m[i][1], self->m[i][2]);
+	return 1;
+}
+
+static int GetColumn(lua_State *L)
+{
+	check_set_mat3(1, self);
+	int j = check_index(L, 2);
+	push_Vector3_up(L, self->m[0][j], self->m[1][j], self->m[2][j]);
+	return 1;
+}
+
+static int Determinant(lua_State *L)
+{
+	check_set_mat3(1, self);
+	push_fix_up(L, mat3_determinant(self));
+	return 1;
+}
+
+static int Transpose(lua_State *L)
+{
+	check_set_mat3(1, self);
+	Matrix3 m = *self;
+	Matrix3 *p = push_Matrix3_up(L);
+	for (int i = 0; i < 3; i++)
+	{
+		for (int j = 0; j < 3; j++)
+		{
+			p->m[i][j] = m.m[j][i];
+		}
+	}
+	return 1;
+}
+
+// 逆矩阵的三列是行向量两两的叉积除以行列式, 不可逆时返回 0
+int mat3_inverse(Matrix3 *self, Matrix3 *out)
+{
+	Vector3 r0, r1, r2, c0, c1, c2;
+	mat3_row(self, 0, &r0);
+	mat3_row(self, 1, &r1);
+	mat3_row(self, 2, &r2);
+	vec3_cross(&r1, &r2, &c0);
+	vec3_cross(&r2, &r0, &c1);
+	vec3_cross(&r0, &r1, &c2);
+	sll det = vec3_dot(&r0, &c0);
+	if (det == 0)
+	{
+		return 0;
+	}
+	out->m[0][0] = slldiv(c0.x, det);
+	out->m[1][0] = slldiv(c0.y, det);
+	out->m[2][0] = slldiv(c0.z, det);
+	out->m[0][1] = slldiv(c1.x, det);
+	out->m[1][1] = slldiv(c1.y, det);
+	out->m[2][1] = slldiv(c1.z, det);
+	out->m[0][2] = slldiv(c2.x, det);
+	out->m[1][2] = slldiv(c2.y, det);
+	out->m[2][2] = slldiv(c2.z, det);
+	return 1;
+}
+
+static int Inverse(lua_State *L)
+{
+	check_set_mat3(1, self);
+	Matrix3 ret;
+	if (!mat3_inverse(self, &ret))
+	{
+		return luaL_error(L, "矩阵不可逆");
+	}
+	*push_Matrix3_up(L) = ret;
+	return 1;
+}
+
+// mat3 * mat3 是矩阵乘法, mat3 * vec3 是变换向量
+static int Mul(lua_State *L)
+{
+	check_set_mat3(1, self);
+	Matrix3 *b = fix_testudata(L, 2, FIX_META_MAT3, __MATRIX3_META__);
+	if (b)
+	{
+		Matrix3 ret;
+		mat3_mul(self, b, &ret);
+		*push_Matrix3_up(L) = ret;
+		return 1;
+	}
+	check_set_vec3(2, v);
+	Vector3 ret;
+	mat3_mul_vec3(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// self = self * b
+static int MulInPlace(lua_State *L)
+{
+	check_set_mat3(1, self);
+	check_set_mat3(2, b);
+	mat3_mul(self, b, self);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int Transform(lua_State *L)
+{
+	check_set_mat3(1, self);
+	check_set_vec3(2, v);
+	Vector3 ret;
+	mat3_mul_vec3(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// out = self * v, out 可以就是 v
+static int TransformInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_mat3(2, self);
+	check_set_vec3(3, v);
+	mat3_mul_vec3(self, v, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 原地变换 fix_vec3_array 的每个元素
+static int TransformArray(lua_State *L)
+{
+	check_set_mat3(1, self);
+	check_set_vec3_array(2, arr);
+	Vector3 r0, r1, r2, v;
+	mat3_row(self, 0, &r0);
+	mat3_row(self, 1, &r1);
+	mat3_row(self, 2, &r2);
+	for (int i = 0; i < arr->n; i++)
+	{
+		v.x = arr->x[i];
+		v.y = arr->y[i];
+		v.z = arr->z[i];
+		arr->x[i] = vec3_dot(&r0, &v);
+		arr->y[i] = vec3_dot(&r1, &v);
+		arr->z[i] = vec3_dot(&r2, &v);
+	}
+	lua_settop(L, 2);
+	return 1;
+}
+
+static int Equal(lua_State *L)
+{
+	check_set_mat3(1, self);
+	check_set_mat3(2, b);
+	lua_pushboolean(L, memcmp(self->m, b->m, sizeof(self->m)) == 0);
+	return 1;
+}
+
+static int mat3_tostring(lua_State *L)
+{
+	char cons[192];
+	check_set_mat3(1, self);
+	int n = 0;
+	for (int i = 0; i < 3; i++)
+	{
+		cons[n++] = i == 0 ? '[' : ',';
+		n += fix_format_tuple(cons + n, self->m[i], 3);
+	}
+	cons[n++] = ']';
+	lua_pushlstring(L, cons, n);
+	return 1;
+}
+
+const luaL_Reg lua_mat3_meta_methods[] = {
+	{"__mul",   Mul},
+	{"__eq",   Equal},
+	{"__tostring",   mat3_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_mat3_modules[] = {
+	{"New",   New},
+	{"Identity",   Identity},
+	{"FromRows",   FromRows},
+	{"FromRotation",   FromRotation},
+	{"FromScale",   FromScale},
+	{"Get",   Get},
+	{"Set",   Set},
+	{"GetRow",   GetRow},
+	{"GetColumn",   GetColumn},
+	{"Determinant",   Determinant},
+	{"Transpose",   Transpose},
+	{"Inverse",   Inverse},
+	{"MulInPlace",   MulInPlace},
+	{"Transform",   Transform},
+	{"TransformInto",   TransformInto},
+	{"TransformArray",   TransformArray},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_mat3(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_mat3", lua_mat3_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_mat3_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_mat3_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
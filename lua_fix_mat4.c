@@ -0,0 +1,470 @@
+#include "math-sll.h"
+#include <string.h>
+
+/*
+	fix_mat4: 4x4 定点矩阵, 按行存, 作用在列向量上 (p' = M * p)
+	TRS 的平移在最后一列; TransformPoint 按 w = 1 变换, 不做透视除法
+	Get/Set 的行列下标和 Lua 一样从 1 开始
+*/
+
+Matrix4 *push_Matrix4(lua_State *L)
+{
+	Matrix4* p = lua_newuserdata(L, sizeof(Matrix4));
+	luaL_getmetatable(L, __MATRIX4_META__);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// 同 push_Matrix4, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+Matrix4 *push_Matrix4_up(lua_State *L)
+{
+	Matrix4* p = lua_newuserdata(L, sizeof(Matrix4));
+	fix_push_meta_up(L, FIX_META_MAT4);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// 第 i 行的前三列
+static void mat4_row3(Matrix4 *self, int i, Vector3 *out)
+{
+	out->x = self->m[i][0];
+	out->y = self->m[i][1];
+	out->z = self->m[i][2];
+}
+
+static void mat4_identity(Matrix4 *self)
+{
+	memset(self, 0, sizeof(Matrix4));
+	self->m[0][0] = CONST_1;
+	self->m[1][1] = CONST_1;
+	self->m[2][2] = CONST_1;
+	self->m[3][3] = CONST_1;
+}
+
+// T * R * S, 旋转矩阵的第 j 列乘 scale 的第 j 个分量
+static void mat4_trs(Vector3 *t, Vector4 *q, Vector3 *s, Matrix4 *out)
+{
+	Matrix3 r;
+	mat3_from_rot4(q, &r);
+	for (int i = 0; i < 3; i++)
+	{
+		out->m[i][0] = sllmul(r.m[i][0], s->x);
+		out->m[i][1] = sllmul(r.m[i][1], s->y);
+		out->m[i][2] = sllmul(r.m[i][2], s->z);
+	}
+	out->m[0][3] = t->x;
+	out->m[1][3] = t->y;
+	out->m[2][3] = t->z;
+	out->m[3][0] = CONST_0;
+	out->m[3][1] = CONST_0;
+	out->m[3][2] = CONST_0;
+	out->m[3][3] = CONST_1;
+}
+
+// out = a * b, out 可以就是 a 或 b
+void mat4_mul(Matrix4 *a, Matrix4 *b, Matrix4 *out)
+{
+	Matrix4 ret;
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			ret.m[i][j] = slldot4(a->m[i][0], b->m[0][j], a->m[i][1], b->m[1][j],
+				a->m[i][2], b->m[2][j], a->m[i][3], b->m[3][j]);
+		}
+	}
+	*out = ret;
+}
+
+// out = self * (a, 1), out 可以就是 a
+void mat4_transform_point(Matrix4 *self, Vector3 *a, Vector3 *out)
+{
+	Vector3 r0, r1, r2;
+	mat4_row3(self, 0, &r0);
+	mat4_row3(self, 1, &r1);
+	mat4_row3(self, 2, &r2);
+	sll x = slladd(vec3_dot(&r0, a), self->m[0][3]);
+	sll y = slladd(vec3_dot(&r1, a), self->m[1][3]);
+	sll z = slladd(vec3_dot(&r2, a), self->m[2][3]);
+	out->x = x;
+	out->y = y;
+	out->z = z;
+}
+
+// out = self * (a, 0), 只用左上 3x3, out 可以就是 a
+void mat4_transform_direction(Matrix4 *self, Vector3 *a, Vector3 *out)
+{
+	Vector3 r0, r1, r2;
+	mat4_row3(self, 0, &r0);
+	mat4_row3(self, 1, &r1);
+	mat4_row3(self, 2, &r2);
+	sll x = vec3_dot(&r0, a);
+	sll y = vec3_dot(&r1, a);
+	sll z = vec3_dot(&r2, a);
+	out->x = x;
+	out->y = y;
+	out->z = z;
+}
+
+// a * b - c * d, 舍入一次
+#define M2(a, b, c, d)	slldot2(a, b, sllneg(c), d)
+// a * b - c * d + e * f, 舍入一次
+#define M3(a, b, c, d, e, f)	slldot3(a, b, sllneg(c), d, e, f)
+
+// 上两行和下两行的 2x2 子式, 行列式和逆矩阵共用; 返回行列式
+static sll mat4_subfactors(Matrix4 *self, sll s[6], sll c[6])
+{
+	sll (*a)[4] = self->m;
+	s[0] = M2(a[0][0], a[1][1], a[1][0], a[0][1]);
+	s[1] = M2(a[0][0], a[1][2], a[1][0], a[0][2]);
+	s[2] = M2(a[0][0], a[1][3], a[1][0], a[0][3]);
+	s[3] = M2(a[0][1], a[1][2], a[1][1], a[0][2]);
+	s[4] = M2(a[0][1], a[1][3], a[1][1], a[0][3]);
+	s[5] = M2(a[0][2], a[1][3], a[1][2], a[0][3]);
+	c[5] = M2(a[2][2], a[3][3], a[3][2], a[2][3]);
+	c[4] = M2(a[2][1], a[3][3], a[3][1], a[2][3]);
+	c[3] = M2(a[2][1], a[3][2], a[3][1], a[2][2]);
+	c[2] = M2(a[2][0], a[3][3], a[3][0], a[2][3]);
+	c[1] = M2(a[2][0], a[3][2], a[3][0], a[2][2]);
+	c[0] = M2(a[2][0], a[3][1], a[3][0], a[2][1]);
+	return slladd(M3(s[0], c[5], s[1], c[4], s[2], c[3]), M3(s[3], c[2], s[4], c[1], s[5], c[0]));
+}
+
+static sll mat4_determinant(Matrix4 *self)
+{
+	sll s[6], c[6];
+	return mat4_subfactors(self, s, c);
+}
+
+// 伴随矩阵除以行列式; 不可逆时返回 0
+int mat4_inverse(Matrix4 *self, Matrix4 *out)
+{
+	sll (*a)[4] = self->m;
+	sll s[6], c[6];
+	sll det = mat4_subfactors(self, s, c);
+	if (det == 0)
+	{
+		return 0;
+	}
+	Matrix4 r;
+	r.m[0][0] = M3(a[1][1], c[5], a[1][2], c[4], a[1][3], c[3]);
+	r.m[0][1] = M3(a[0][2], c[4], a[0][1], c[5], sllneg(a[0][3]), c[3]);
+	r.m[0][2] = M3(a[3][1], s[5], a[3][2], s[4], a[3][3], s[3]);
+	r.m[0][3] = M3(a[2][2], s[4], a[2][1], s[5], sllneg(a[2][3]), s[3]);
+	r.m[1][0] = M3(a[1][2], c[2], a[1][0], c[5], sllneg(a[1][3]), c[1]);
+	r.m[1][1] = M3(a[0][0], c[5], a[0][2], c[2], a[0][3], c[1]);
+	r.m[1][2] = M3(a[3][2], s[2], a[3][0], s[5], sllneg(a[3][3]), s[1]);
+	r.m[1][3] = M3(a[2][0], s[5], a[2][2], s[2], a[2][3], s[1]);
+	r.m[2][0] = M3(a[1][0], c[4], a[1][1], c[2], a[1][3], c[0]);
+	r.m[2][1] = M3(a[0][1], c[2], a[0][0], c[4], sllneg(a[0][3]), c[0]);
+	r.m[2][2] = M3(a[3][0], s[4], a[3][1], s[2], a[3][3], s[0]);
+	r.m[2][3] = M3(a[2][1], s[2], a[2][0], s[4], sllneg(a[2][3]), s[0]);
+	r.m[3][0] = M3(a[1][1], c[1], a[1][0], c[3], sllneg(a[1][2]), c[0]);
+	r.m[3][1] = M3(a[0][0], c[3], a[0][1], c[1], a[0][2], c[0]);
+	r.m[3][2] = M3(a[3][1], s[1], a[3][0], s[3], sllneg(a[3][2]), s[0]);
+	r.m[3][3] = M3(a[2][0], s[3], a[2][1], s[1], a[2][2], s[0]);
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			out->m[i][j] = slldiv(r.m[i][j], det);
+		}
+	}
+	return 1;
+}
+
+#undef M2
+#undef M3
+
+// 行列下标从 1 开始, 返回 C 下标
+static int check_index(lua_State *L, int idx)
+{
+	lua_Integer i = luaL_checkinteger(L, idx);
+	luaL_argcheck(L, i >= 1 && i <= 4, idx, "下标越界");
+	return (int)(i - 1);
+}
+
+// 16 个定点数, 按行给出
+static int New(lua_State *L)
+{
+	Matrix4 m;
+	for (int i = 0; i < 16; i++)
+	{
+		check_set_fix(i + 1, v);
+		m.m[i / 4][i % 4] = *v;
+	}
+	*push_Matrix4_up(L) = m;
+	return 1;
+}
+
+static int Identity(lua_State *L)
+{
+	mat4_identity(push_Matrix4_up(L));
+	return 1;
+}
+
+static int TRS(lua_State *L)
+{
+	check_set_vec3(1, t);
+	check_set_rot4(2, q);
+	check_set_vec3(3, s);
+	mat4_trs(t, q, s, push_Matrix4_up(L));
+	return 1;
+}
+
+static int FromTranslation(lua_State *L)
+{
+	check_set_vec3(1, t);
+	Matrix4 *p = push_Matrix4_up(L);
+	mat4_identity(p);
+	p->m[0][3] = t->x;
+	p->m[1][3] = t->y;
+	p->m[2][3] = t->z;
+	return 1;
+}
+
+static int FromRotation(lua_State *L)
+{
+	check_set_rot4(1, q);
+	Vector3 zero = {CONST_0, CONST_0, CONST_0};
+	Vector3 one = {CONST_1, CONST_1, CONST_1};
+	mat4_trs(&zero, q, &one, push_Matrix4_up(L));
+	return 1;
+}
+
+static int FromScale(lua_State *L)
+{
+	check_set_vec3(1, s);
+	Matrix4 *p = push_Matrix4_up(L);
+	mat4_identity(p);
+	p->m[0][0] = s->x;
+	p->m[1][1] = s->y;
+	p->m[2][2] = s->z;
+	return 1;
+}
+
+static int Get(lua_State *L)
+{
+	check_set_mat4(1, self);
+	int i = check_index(L, 2);
+	int j = check_index(L, 3);
+	push_fix_up(L, self->m[i][j]);
+	return 1;
+}
+
+static int Set(lua_State *L)
+{
+	check_set_mat4(1, self);
+	int i = check_index(L, 2);
+	int j = check_index(L, 3);
+	check_set_fix(4, v);
+	self->m[i][j] = *v;
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int GetPosition(lua_State *L)
+{
+	check_set_mat4(1, self);
+	push_Vector3_up(L, self->m[0][3], self->m[1][3], self->m[2][3]);
+	return 1;
+}
+
+static int Determinant(lua_State *L)
+{
+	check_set_mat4(1, self);
+	push_fix_up(L, mat4_determinant(self));
+	return 1;
+}
+
+static int Transpose(lua_State *L)
+{
+	check_set_mat4(1, self);
+	Matrix4 m = *self;
+	Matrix4 *p = push_Matrix4_up(L);
+	for (int i = 0; i < 4; i++)
+	{
+		for (int j = 0; j < 4; j++)
+		{
+			p->m[i][j] = m.m[j][i];
+		}
+	}
+	return 1;
+}
+
+static int Inverse(lua_State *L)
+{
+	check_set_mat4(1, self);
+	Matrix4 ret;
+	if (!mat4_inverse(self, &ret))
+	{
+		return luaL_error(L, "矩阵不可逆");
+	}
+	*push_Matrix4_up(L) = ret;
+	return 1;
+}
+
+// mat4 * mat4 是矩阵乘法, mat4 * vec3 同 TransformPoint
+static int Mul(lua_State *L)
+{
+	check_set_mat4(1, self);
+	Matrix4 *b = fix_testudata(L, 2, FIX_META_MAT4, __MATRIX4_META__);
+	if (b)
+	{
+		Matrix4 ret;
+		mat4_mul(self, b, &ret);
+		*push_Matrix4_up(L) = ret;
+		return 1;
+	}
+	check_set_vec3(2, v);
+	Vector3 ret;
+	mat4_transform_point(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// self = self * b
+static int MulInPlace(lua_State *L)
+{
+	check_set_mat4(1, self);
+	check_set_mat4(2, b);
+	mat4_mul(self, b, self);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int TransformPoint(lua_State *L)
+{
+	check_set_mat4(1, self);
+	check_set_vec3(2, v);
+	Vector3 ret;
+	mat4_transform_point(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+static int TransformDirection(lua_State *L)
+{
+	check_set_mat4(1, self);
+	check_set_vec3(2, v);
+	Vector3 ret;
+	mat4_transform_direction(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// out = self * (v, 1), out 可以就是 v
+static int TransformPointInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_mat4(2, self);
+	check_set_vec3(3, v);
+	mat4_transform_point(self, v, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// out = self * (v, 0), out 可以就是 v
+static int TransformDirectionInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_mat4(2, self);
+	check_set_vec3(3, v);
+	mat4_transform_direction(self, v, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 原地变换 fix_vec3_array, 第三个参数为 true 时按方向变换 (不加平移)
+static int TransformArray(lua_State *L)
+{
+	check_set_mat4(1, self);
+	check_set_vec3_array(2, arr);
+	int direction = lua_toboolean(L, 3);
+	Vector3 r0, r1, r2, v;
+	mat4_row3(self, 0, &r0);
+	mat4_row3(self, 1, &r1);
+	mat4_row3(self, 2, &r2);
+	sll tx = direction ? CONST_0 : self->m[0][3];
+	sll ty = direction ? CONST_0 : self->m[1][3];
+	sll tz = direction ? CONST_0 : self->m[2][3];
+	for (int i = 0; i < arr->n; i++)
+	{
+		v.x = arr->x[i];
+		v.y = arr->y[i];
+		v.z = arr->z[i];
+		arr->x[i] = slladd(vec3_dot(&r0, &v), tx);
+		arr->y[i] = slladd(vec3_dot(&r1, &v), ty);
+		arr->z[i] = slladd(vec3_dot(&r2, &v), tz);
+	}
+	lua_settop(L, 2);
+	return 1;
+}
+
+static int Equal(lua_State *L)
+{
+	check_set_mat4(1, self);
+	check_set_mat4(2, b);
+	lua_pushboolean(L, memcmp(self->m, b->m, sizeof(self->m)) == 0);
+	return 1;
+}
+
+static int mat4_tostring(lua_State *L)
+{
+	char cons[320];
+	check_set_mat4(1, self);
+	int n = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		cons[n++] = i == 0 ? '[' : ',';
+		n += fix_format_tuple(cons + n, self->m[i], 4);
+	}
+	cons[n++] = ']';
+	lua_pushlstring(L, cons, n);
+	return 1;
+}
+
+const luaL_Reg lua_mat4_meta_methods[] = {
+	{"__mul",   Mul},
+	{"__eq",   Equal},
+	{"__tostring",   mat4_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_mat4_modules[] = {
+	{"New",   New},
+	{"Identity",   Identity},
+	{"TRS",   TRS},
+	{"FromTranslation",   FromTranslation},
+	{"FromRotation",   FromRotation},
+	{"FromScale",   FromScale},
+	{"Get",   Get},
+	{"Set",   Set},
+	{"GetPosition",   GetPosition},
+	{"Determinant",   Determinant},
+	{"Transpose",   Transpose},
+	{"Inverse",   Inverse},
+	{"MulInPlace",   MulInPlace},
+	{"TransformPoint",   TransformPoint},
+	{"TransformDirection",   TransformDirection},
+	{"TransformPointInto",   TransformPointInto},
+	{"TransformDirectionInto",   TransformDirectionInto},
+	{"TransformArray",   TransformArray},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_mat4(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_mat4", lua_mat4_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_mat4_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_mat4_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
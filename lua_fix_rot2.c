@@ -0,0 +1,277 @@
+#include "math-sll.h"
+
+/*
+	fix_rot2: 二维旋转, 存 cos/sin 两个值 (x = cos, y = sin)
+	旋转一个向量只要 4 次乘法, 角度只在构造时算一次 sincos
+	角度和 fix_vec2.Angle 一样用角度制, 逆时针为正
+*/
+
+void push_Rot2(lua_State *L, sll c, sll s)
+{
+	Vector2* p = lua_newuserdata(L, sizeof(Vector2));
+	p->x = c;
+	p->y = s;
+	luaL_getmetatable(L, __ROT2_META__);
+	lua_setmetatable(L, -2);
+}
+
+// 同 push_Rot2, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+void push_Rot2_up(lua_State *L, sll c, sll s)
+{
+	Vector2* p = lua_newuserdata(L, sizeof(Vector2));
+	p->x = c;
+	p->y = s;
+	fix_push_meta_up(L, FIX_META_ROT2);
+	lua_setmetatable(L, -2);
+}
+
+// out = self * a, out 可以就是 a 或 self
+// a 是向量时得到旋转后的向量, a 是旋转时得到两次旋转的复合
+void rot_mul_vec2(Vector2 *self, Vector2 *a, Vector2 *out)
+{
+	sll x = sllsub(sllmul(self->x, a->x), sllmul(self->y, a->y));
+	sll y = slladd(sllmul(self->y, a->x), sllmul(self->x, a->y));
+	out->x = x;
+	out->y = y;
+}
+
+// 对 n 个点 (x[i], y[i]) 做同一个旋转
+static void rot2_rotate_lanes(Vector2 *self, sll *x, sll *y, int n)
+{
+	Vector2 v;
+	for (int i = 0; i < n; i++)
+	{
+		v.x = x[i];
+		v.y = y[i];
+		rot_mul_vec2(self, &v, &v);
+		x[i] = v.x;
+		y[i] = v.y;
+	}
+}
+
+// 角度制
+static int New(lua_State *L)
+{
+	check_set_fix(1, deg);
+	sll s, c;
+	sllsincos(sllmul(*deg, CONST_PI_180), &s, &c);
+	push_Rot2_up(L, c, s);
+	return 1;
+}
+
+static int FromRadians(lua_State *L)
+{
+	check_set_fix(1, rad);
+	sll s, c;
+	sllsincos(*rad, &s, &c);
+	push_Rot2_up(L, c, s);
+	return 1;
+}
+
+// 直接给 cos/sin, 不检查是否单位长度
+static int FromCosSin(lua_State *L)
+{
+	check_set_fix(1, c);
+	check_set_fix(2, s);
+	push_Rot2_up(L, *c, *s);
+	return 1;
+}
+
+// 把 from 的方向转到 to 的方向
+static int FromToRotation(lua_State *L)
+{
+	check_set_vec2(1, from);
+	check_set_vec2(2, to);
+	Vector2 _from = *from;
+	Vector2 _to = *to;
+	vec2_set_normalize(&_from);
+	vec2_set_normalize(&_to);
+	push_Rot2_up(L, vec2_dot(&_from, &_to), vec2_cross(&_from, &_to));
+	return 1;
+}
+
+static int Identity(lua_State *L)
+{
+	push_Rot2_up(L, CONST_1, CONST_0);
+	return 1;
+}
+
+static int get_cos(lua_State *L)
+{
+	check_set_rot2(1, self);
+	push_fix_up(L, self->x);
+	return 1;
+}
+
+static int get_sin(lua_State *L)
+{
+	check_set_rot2(1, self);
+	push_fix_up(L, self->y);
+	return 1;
+}
+
+// 角度制, (-180, 180]
+static int Angle(lua_State *L)
+{
+	check_set_rot2(1, self);
+	push_fix_up(L, sllmul(sllatan2(self->y, self->x), CONST_180_PI));
+	return 1;
+}
+
+static int Inverse(lua_State *L)
+{
+	check_set_rot2(1, self);
+	push_Rot2_up(L, self->x, sllneg(self->y));
+	return 1;
+}
+
+// 多次复合以后长度会漂移, 需要时重新归一
+static int SetNormalize(lua_State *L)
+{
+	check_set_rot2(1, self);
+	vec2_set_normalize(self);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// rot * rot 是复合, rot * vec2 是旋转向量
+static int Mul(lua_State *L)
+{
+	check_set_rot2(1, self);
+	Vector2 ret;
+	Vector2 *b = fix_testudata(L, 2, FIX_META_ROT2, __ROT2_META__);
+	if (b)
+	{
+		rot_mul_vec2(self, b, &ret);
+		push_Rot2_up(L, ret.x, ret.y);
+		return 1;
+	}
+	check_set_vec2(2, v);
+	rot_mul_vec2(self, v, &ret);
+	push_Vector2_up(L, ret.x, ret.y);
+	return 1;
+}
+
+static int Rotate(lua_State *L)
+{
+	check_set_rot2(1, self);
+	check_set_vec2(2, v);
+	Vector2 ret;
+	rot_mul_vec2(self, v, &ret);
+	push_Vector2_up(L, ret.x, ret.y);
+	return 1;
+}
+
+// out = self * v, out 可以就是 v
+static int RotateInto(lua_State *L)
+{
+	check_set_vec2(1, out);
+	check_set_rot2(2, self);
+	check_set_vec2(3, v);
+	rot_mul_vec2(self, v, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int InverseRotate(lua_State *L)
+{
+	check_set_rot2(1, self);
+	check_set_vec2(2, v);
+	Vector2 inv = {self->x, sllneg(self->y)};
+	Vector2 ret;
+	rot_mul_vec2(&inv, v, &ret);
+	push_Vector2_up(L, ret.x, ret.y);
+	return 1;
+}
+
+// 原地旋转 fix_vec3_array 的 x/z 两条 lane, 和 fix_vec2 <-> fix_vec3 的 (x, y) <-> (x, z) 对应
+static int RotateArray(lua_State *L)
+{
+	check_set_rot2(1, self);
+	check_set_vec3_array(2, arr);
+	rot2_rotate_lanes(self, arr->x, arr->z, arr->n);
+	lua_settop(L, 2);
+	return 1;
+}
+
+// 原地旋转一个 fix_vec2 数组 (Lua table, 下标 1..n)
+static int RotateTable(lua_State *L)
+{
+	check_set_rot2(1, self);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	int n = (int)lua_rawlen(L, 2);
+	for (int i = 1; i <= n; i++)
+	{
+		lua_rawgeti(L, 2, i);
+		Vector2 *v = fix_testudata(L, -1, FIX_META_VEC2, __VECTOR2_META__);
+		if (!v)
+		{
+			return luaL_error(L, "第2个参数的第%d个元素不是一个fix_vec2", i);
+		}
+		rot_mul_vec2(self, v, v);
+		lua_pop(L, 1);
+	}
+	lua_settop(L, 2);
+	return 1;
+}
+
+static int Equal(lua_State *L)
+{
+	check_set_rot2(1, self);
+	check_set_rot2(2, b);
+	lua_pushboolean(L, (self->x == b->x && self->y == b->y));
+	return 1;
+}
+
+static int rot2_tostring(lua_State *L)
+{
+	char cons[SLL_STR_MAX + 8] = "rot2(";
+	check_set_rot2(1, self);
+	int n = 5;
+	n += sll2str(sllmul(sllatan2(self->y, self->x), CONST_180_PI), 6, cons + n);
+	cons[n++] = ')';
+	lua_pushlstring(L, cons, n);
+	return 1;
+}
+
+const luaL_Reg lua_rot2_meta_methods[] = {
+	{"__mul",   Mul},
+	{"__eq",   Equal},
+	{"__tostring",   rot2_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_rot2_modules[] = {
+	{"New",   New},
+	{"FromRadians",   FromRadians},
+	{"FromCosSin",   FromCosSin},
+	{"FromToRotation",   FromToRotation},
+	{"Identity",   Identity},
+	{"get_cos",   get_cos},
+	{"get_sin",   get_sin},
+	{"Angle",   Angle},
+	{"Inverse",   Inverse},
+	{"SetNormalize",   SetNormalize},
+	{"Rotate",   Rotate},
+	{"RotateInto",   RotateInto},
+	{"InverseRotate",   InverseRotate},
+	{"RotateArray",   RotateArray},
+	{"RotateTable",   RotateTable},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_rot2(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_rot2", lua_rot2_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_rot2_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_rot2_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
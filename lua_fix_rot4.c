@@ -0,0 +1,565 @@
+#include "math-sll.h"
+
+/*
+	fix_rot4: 四元数旋转, 用 Vector4 存 (x, y, z, w)
+	约定和 Unity 的 Quaternion 一致: 角度制, Euler 按 z, x, y 的顺序旋转
+	全部是定点运算, 各平台结果逐位相同
+*/
+
+// 点积大于这个值时 Slerp 退化成 Nlerp, 0.9995
+#define ROT4_SLERP_LINEAR	0x00000000ffdf3b64LL
+
+void push_Rot4(lua_State *L, sll x, sll y, sll z, sll w)
+{
+	Vector4* p = lua_newuserdata(L, sizeof(Vector4));
+	p->x = x;
+	p->y = y;
+	p->z = z;
+	p->w = w;
+	luaL_getmetatable(L, __ROT4_META__);
+	lua_setmetatable(L, -2);
+}
+
+// 同 push_Rot4, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+void push_Rot4_up(lua_State *L, sll x, sll y, sll z, sll w)
+{
+	Vector4* p = lua_newuserdata(L, sizeof(Vector4));
+	p->x = x;
+	p->y = y;
+	p->z = z;
+	p->w = w;
+	fix_push_meta_up(L, FIX_META_ROT4);
+	lua_setmetatable(L, -2);
+}
+
+// out = a * b, 先转 b 再转 a, out 可以就是 a 或 b
+void rot4_mul(Vector4 *a, Vector4 *b, Vector4 *out)
+{
+	sll x = slladd(slladd(sllmul(a->w, b->x), sllmul(a->x, b->w)), sllsub(sllmul(a->y, b->z), sllmul(a->z, b->y)));
+	sll y = slladd(sllsub(sllmul(a->w, b->y), sllmul(a->x, b->z)), slladd(sllmul(a->y, b->w), sllmul(a->z, b->x)));
+	sll z = slladd(slladd(sllmul(a->w, b->z), sllmul(a->x, b->y)), sllsub(sllmul(a->z, b->w), sllmul(a->y, b->x)));
+	sll w = sllsub(sllsub(sllmul(a->w, b->w), sllmul(a->x, b->x)), slladd(sllmul(a->y, b->y), sllmul(a->z, b->z)));
+	out->x = x;
+	out->y = y;
+	out->z = z;
+	out->w = w;
+}
+
+// t = 2 (q.xyz x v), v' = v + w t + q.xyz x t, out 可以就是 a
+void rot4_mul_vec3(Vector4 *self, Vector3 *a, Vector3 *out)
+{
+	Vector3 u = {self->x, self->y, self->z};
+	Vector3 t, c;
+	vec3_cross(&u, a, &t);
+	t.x = sllmul2(t.x);
+	t.y = sllmul2(t.y);
+	t.z = sllmul2(t.z);
+	vec3_cross(&u, &t, &c);
+	out->x = slladd(a->x, slladd(sllmul(self->w, t.x), c.x));
+	out->y = slladd(a->y, slladd(sllmul(self->w, t.y), c.y));
+	out->z = slladd(a->z, slladd(sllmul(self->w, t.z), c.z));
+}
+
+static sll rot4_dot(Vector4 *a, Vector4 *b)
+{
+	return slldot4(a->x, b->x, a->y, b->y, a->z, b->z, a->w, b->w);
+}
+
+// 和 vec3_set_normalize 一样先按 2 的幂缩放, 再一次 rsqrt; 零四元数变成单位四元数
+void rot4_set_normalize(Vector4 *self)
+{
+	ull ax = (self->x < 0) ? 0 - (ull)self->x : (ull)self->x;
+	ull ay = (self->y < 0) ? 0 - (ull)self->y : (ull)self->y;
+	ull az = (self->z < 0) ? 0 - (ull)self->z : (ull)self->z;
+	ull aw = (self->w < 0) ? 0 - (ull)self->w : (ull)self->w;
+	ull am = max(max(ax, ay), max(az, aw));
+	int n = sllbitlen(am) - 33;
+	if (n > -33)
+	{
+		Vector4 v;
+		v.x = (n > 0) ? self->x >> n : self->x << -n;
+		v.y = (n > 0) ? self->y >> n : self->y << -n;
+		v.z = (n > 0) ? self->z >> n : self->z << -n;
+		v.w = (n > 0) ? self->w >> n : self->w << -n;
+		sll r = sllrsqrt(rot4_dot(&v, &v));
+		self->x = sllmul(v.x, r);
+		self->y = sllmul(v.y, r);
+		self->z = sllmul(v.z, r);
+		self->w = sllmul(v.w, r);
+	}
+	else
+	{
+		self->x = CONST_0;
+		self->y = CONST_0;
+		self->z = CONST_0;
+		self->w = CONST_1;
+	}
+}
+
+// 绕单位轴 axis 转 rad 弧度
+static void rot4_axis_angle(Vector3 *axis, sll rad, Vector4 *out)
+{
+	sll s, c;
+	sllsincos(slldiv2(rad), &s, &c);
+	out->x = sllmul(axis->x, s);
+	out->y = sllmul(axis->y, s);
+	out->z = sllmul(axis->z, s);
+	out->w = c;
+}
+
+// b 取 a 同侧的那个, 点积不为负, 走短弧
+static sll rot4_align(Vector4 *a, Vector4 *b)
+{
+	sll d = rot4_dot(a, b);
+	if (d < 0)
+	{
+		b->x = sllneg(b->x);
+		b->y = sllneg(b->y);
+		b->z = sllneg(b->z);
+		b->w = sllneg(b->w);
+		d = sllneg(d);
+	}
+	return d;
+}
+
+static void rot4_nlerp(Vector4 *a, Vector4 *b, sll t, Vector4 *out)
+{
+	Vector4 _b = *b;
+	rot4_align(a, &_b);
+	out->x = slladd(a->x, sllmul(sllsub(_b.x, a->x), t));
+	out->y = slladd(a->y, sllmul(sllsub(_b.y, a->y), t));
+	out->z = slladd(a->z, sllmul(sllsub(_b.z, a->z), t));
+	out->w = slladd(a->w, sllmul(sllsub(_b.w, a->w), t));
+	rot4_set_normalize(out);
+}
+
+// 夹角很小时 sin(theta) 接近 0, 改用 Nlerp
+static void rot4_slerp(Vector4 *a, Vector4 *b, sll t, Vector4 *out)
+{
+	Vector4 _b = *b;
+	sll d = rot4_align(a, &_b);
+	if (d > ROT4_SLERP_LINEAR)
+	{
+		rot4_nlerp(a, &_b, t, out);
+		return;
+	}
+	sll theta = sllacos(d);
+	sll inv = sllinv(sllsin(theta));
+	sll sa = sllmul(sllsin(sllmul(sllsub(CONST_1, t), theta)), inv);
+	sll sb = sllmul(sllsin(sllmul(t, theta)), inv);
+	out->x = slladd(sllmul(a->x, sa), sllmul(_b.x, sb));
+	out->y = slladd(sllmul(a->y, sa), sllmul(_b.y, sb));
+	out->z = slladd(sllmul(a->z, sa), sllmul(_b.z, sb));
+	out->w = slladd(sllmul(a->w, sa), sllmul(_b.w, sb));
+	rot4_set_normalize(out);
+}
+
+// 列向量为 right, up, forward 的旋转矩阵 -> 四元数, 每个分支一次 rsqrt
+static void rot4_from_basis(Vector3 *r, Vector3 *u, Vector3 *f, Vector4 *out)
+{
+	sll t, rs, s;
+	sll tr = slladd(slladd(r->x, u->y), f->z);
+	if (tr > 0)
+	{
+		t = slladd(CONST_1, tr);
+		rs = sllrsqrt(t);
+		s = slldiv2(rs);
+		out->w = slldiv2(sllmul(t, rs));
+		out->x = sllmul(sllsub(u->z, f->y), s);
+		out->y = sllmul(sllsub(f->x, r->z), s);
+		out->z = sllmul(sllsub(r->y, u->x), s);
+	}
+	else if (r->x > u->y && r->x > f->z)
+	{
+		t = sllsub(sllsub(slladd(CONST_1, r->x), u->y), f->z);
+		rs = sllrsqrt(t);
+		s = slldiv2(rs);
+		out->x = slldiv2(sllmul(t, rs));
+		out->w = sllmul(sllsub(u->z, f->y), s);
+		out->y = sllmul(slladd(u->x, r->y), s);
+		out->z = sllmul(slladd(f->x, r->z), s);
+	}
+	else if (u->y > f->z)
+	{
+		t = sllsub(sllsub(slladd(CONST_1, u->y), r->x), f->z);
+		rs = sllrsqrt(t);
+		s = slldiv2(rs);
+		out->y = slldiv2(sllmul(t, rs));
+		out->w = sllmul(sllsub(f->x, r->z), s);
+		out->x = sllmul(slladd(u->x, r->y), s);
+		out->z = sllmul(slladd(f->y, u->z), s);
+	}
+	else
+	{
+		t = sllsub(sllsub(slladd(CONST_1, f->z), r->x), u->y);
+		rs = sllrsqrt(t);
+		s = slldiv2(rs);
+		out->z = slldiv2(sllmul(t, rs));
+		out->w = sllmul(sllsub(r->y, u->x), s);
+		out->x = sllmul(slladd(f->x, r->z), s);
+		out->y = sllmul(slladd(f->y, u->z), s);
+	}
+	rot4_set_normalize(out);
+}
+
+static int New(lua_State *L)
+{
+	check_set_fix(1, x);
+	check_set_fix(2, y);
+	check_set_fix(3, z);
+	check_set_fix(4, w);
+	push_Rot4_up(L, *x, *y, *z, *w);
+	return 1;
+}
+
+static int Identity(lua_State *L)
+{
+	push_Rot4_up(L, CONST_0, CONST_0, CONST_0, CONST_1);
+	return 1;
+}
+
+// 角度制, axis 不需要是单位向量
+static int AngleAxis(lua_State *L)
+{
+	check_set_fix(1, deg);
+	check_set_vec3(2, axis);
+	Vector3 _axis = *axis;
+	Vector4 ret;
+	vec3_set_normalize(&_axis);
+	rot4_axis_angle(&_axis, sllmul(*deg, CONST_PI_180), &ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+// 角度制, 先绕 z, 再绕 x, 最后绕 y; 参数是三个定点数或者一个 fix_vec3
+static int Euler(lua_State *L)
+{
+	Vector3 e;
+	Vector3 *v = fix_testudata(L, 1, FIX_META_VEC3, __VECTOR3_META__);
+	if (v)
+	{
+		e = *v;
+	}
+	else
+	{
+		check_set_fix(1, x);
+		check_set_fix(2, y);
+		check_set_fix(3, z);
+		e.x = *x;
+		e.y = *y;
+		e.z = *z;
+	}
+	Vector3 ax = {CONST_1, CONST_0, CONST_0};
+	Vector3 ay = {CONST_0, CONST_1, CONST_0};
+	Vector3 az = {CONST_0, CONST_0, CONST_1};
+	Vector4 qx, qy, qz;
+	rot4_axis_angle(&ax, sllmul(e.x, CONST_PI_180), &qx);
+	rot4_axis_angle(&ay, sllmul(e.y, CONST_PI_180), &qy);
+	rot4_axis_angle(&az, sllmul(e.z, CONST_PI_180), &qz);
+	rot4_mul(&qx, &qz, &qx);
+	rot4_mul(&qy, &qx, &qy);
+	push_Rot4_up(L, qy.x, qy.y, qy.z, qy.w);
+	return 1;
+}
+
+// z 轴朝向 forward, y 轴尽量朝向 up (默认 (0, 1, 0))
+static int LookRotation(lua_State *L)
+{
+	check_set_vec3(1, forward);
+	Vector3 up = {CONST_0, CONST_1, CONST_0};
+	if (!lua_isnoneornil(L, 2))
+	{
+		check_set_vec3(2, _up);
+		up = *_up;
+	}
+	Vector3 f = *forward;
+	Vector3 r, u;
+	Vector4 ret;
+	vec3_set_normalize(&f);
+	if (f.x == 0 && f.y == 0 && f.z == 0)
+	{
+		push_Rot4_up(L, CONST_0, CONST_0, CONST_0, CONST_1);
+		return 1;
+	}
+	vec3_cross(&up, &f, &r);
+	vec3_set_normalize(&r);
+	if (r.x == 0 && r.y == 0 && r.z == 0)
+	{
+		// forward 和 up 平行, 换 x 轴当 up
+		Vector3 right = {CONST_1, CONST_0, CONST_0};
+		vec3_cross(&f, &right, &up);
+		vec3_cross(&up, &f, &r);
+		vec3_set_normalize(&r);
+	}
+	vec3_cross(&f, &r, &u);
+	rot4_from_basis(&r, &u, &f, &ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+static int get_x(lua_State *L)
+{
+	check_set_rot4(1, self);
+	push_fix_up(L, self->x);
+	return 1;
+}
+
+static int get_y(lua_State *L)
+{
+	check_set_rot4(1, self);
+	push_fix_up(L, self->y);
+	return 1;
+}
+
+static int get_z(lua_State *L)
+{
+	check_set_rot4(1, self);
+	push_fix_up(L, self->z);
+	return 1;
+}
+
+static int get_w(lua_State *L)
+{
+	check_set_rot4(1, self);
+	push_fix_up(L, self->w);
+	return 1;
+}
+
+static int Dot(lua_State *L)
+{
+	check_set_rot4(1, a);
+	check_set_rot4(2, b);
+	push_fix_up(L, rot4_dot(a, b));
+	return 1;
+}
+
+// 两个旋转之间的夹角, 角度制
+static int Angle(lua_State *L)
+{
+	check_set_rot4(1, a);
+	check_set_rot4(2, b);
+	sll d = min(sllabs(rot4_dot(a, b)), CONST_1);
+	push_fix_up(L, sllmul(sllmul2(sllacos(d)), CONST_180_PI));
+	return 1;
+}
+
+static int Conjugate(lua_State *L)
+{
+	check_set_rot4(1, self);
+	push_Rot4_up(L, sllneg(self->x), sllneg(self->y), sllneg(self->z), self->w);
+	return 1;
+}
+
+// 共轭除以模的平方, 单位四元数时和 Conjugate 相同
+static int Inverse(lua_State *L)
+{
+	check_set_rot4(1, self);
+	sll n = rot4_dot(self, self);
+	if (n == CONST_1)
+	{
+		push_Rot4_up(L, sllneg(self->x), sllneg(self->y), sllneg(self->z), self->w);
+		return 1;
+	}
+	sll inv = sllinv(n);
+	push_Rot4_up(L, sllneg(sllmul(self->x, inv)), sllneg(sllmul(self->y, inv)),
+		sllneg(sllmul(self->z, inv)), sllmul(self->w, inv));
+	return 1;
+}
+
+static int Normalize(lua_State *L)
+{
+	check_set_rot4(1, self);
+	Vector4 ret = *self;
+	rot4_set_normalize(&ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+static int SetNormalize(lua_State *L)
+{
+	check_set_rot4(1, self);
+	rot4_set_normalize(self);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// rot4 * rot4 是复合, rot4 * vec3 是旋转向量
+static int Mul(lua_State *L)
+{
+	check_set_rot4(1, self);
+	Vector4 *b = fix_testudata(L, 2, FIX_META_ROT4, __ROT4_META__);
+	if (b)
+	{
+		Vector4 ret;
+		rot4_mul(self, b, &ret);
+		push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+		return 1;
+	}
+	check_set_vec3(2, v);
+	Vector3 ret;
+	rot4_mul_vec3(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// self = self * b
+static int MulInPlace(lua_State *L)
+{
+	check_set_rot4(1, self);
+	check_set_rot4(2, b);
+	rot4_mul(self, b, self);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int Rotate(lua_State *L)
+{
+	check_set_rot4(1, self);
+	check_set_vec3(2, v);
+	Vector3 ret;
+	rot4_mul_vec3(self, v, &ret);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
+	return 1;
+}
+
+// out = self * v, out 可以就是 v
+static int RotateInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_rot4(2, self);
+	check_set_vec3(3, v);
+	rot4_mul_vec3(self, v, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 原地旋转 fix_vec3_array 的每个元素
+static int RotateArray(lua_State *L)
+{
+	check_set_rot4(1, self);
+	check_set_vec3_array(2, arr);
+	Vector3 v;
+	for (int i = 0; i < arr->n; i++)
+	{
+		v.x = arr->x[i];
+		v.y = arr->y[i];
+		v.z = arr->z[i];
+		rot4_mul_vec3(self, &v, &v);
+		arr->x[i] = v.x;
+		arr->y[i] = v.y;
+		arr->z[i] = v.z;
+	}
+	lua_settop(L, 2);
+	return 1;
+}
+
+static int Slerp(lua_State *L)
+{
+	check_set_rot4(1, a);
+	check_set_rot4(2, b);
+	check_set_fix(3, t);
+	Vector4 ret;
+	rot4_slerp(a, b, clamp_fix(*t, CONST_0, CONST_1), &ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+static int SlerpUnclamped(lua_State *L)
+{
+	check_set_rot4(1, a);
+	check_set_rot4(2, b);
+	check_set_fix(3, t);
+	Vector4 ret;
+	rot4_slerp(a, b, *t, &ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+// 线性插值再归一, 比 Slerp 快, 角速度不均匀
+static int Nlerp(lua_State *L)
+{
+	check_set_rot4(1, a);
+	check_set_rot4(2, b);
+	check_set_fix(3, t);
+	Vector4 ret;
+	rot4_nlerp(a, b, clamp_fix(*t, CONST_0, CONST_1), &ret);
+	push_Rot4_up(L, ret.x, ret.y, ret.z, ret.w);
+	return 1;
+}
+
+static int Equal(lua_State *L)
+{
+	check_set_rot4(1, self);
+	check_set_rot4(2, b);
+	lua_pushboolean(L, (self->x == b->x && self->y == b->y && self->z == b->z && self->w == b->w));
+	return 1;
+}
+
+static int rot4_tostring(lua_State *L)
+{
+	char cons[96];
+	check_set_rot4(1, self);
+	sll v[4] = {self->x, self->y, self->z, self->w};
+	lua_pushlstring(L, cons, fix_format_tuple(cons, v, 4));
+	return 1;
+}
+
+static int to_number(lua_State *L)
+{
+	check_set_rot4(1, self);
+	lua_pushnumber(L, sll2dbl(self->x));
+	lua_pushnumber(L, sll2dbl(self->y));
+	lua_pushnumber(L, sll2dbl(self->z));
+	lua_pushnumber(L, sll2dbl(self->w));
+	return 4;
+}
+
+const luaL_Reg lua_rot4_meta_methods[] = {
+	{"__mul",   Mul},
+	{"__eq",   Equal},
+	{"__tostring",   rot4_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_rot4_modules[] = {
+	{"New",   New},
+	{"Identity",   Identity},
+	{"AngleAxis",   AngleAxis},
+	{"Euler",   Euler},
+	{"LookRotation",   LookRotation},
+	{"get_x",   get_x},
+	{"get_y",   get_y},
+	{"get_z",   get_z},
+	{"get_w",   get_w},
+	{"Dot",   Dot},
+	{"Angle",   Angle},
+	{"Conjugate",   Conjugate},
+	{"Inverse",   Inverse},
+	{"Normalize",   Normalize},
+	{"SetNormalize",   SetNormalize},
+	{"MulInPlace",   MulInPlace},
+	{"Rotate",   Rotate},
+	{"RotateInto",   RotateInto},
+	{"RotateArray",   RotateArray},
+	{"Slerp",   Slerp},
+	{"SlerpUnclamped",   SlerpUnclamped},
+	{"Nlerp",   Nlerp},
+	{"tonumber",   to_number},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_rot4(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_rot4", lua_rot4_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_rot4_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_rot4_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
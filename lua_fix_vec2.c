@@ -1,29 +1,37 @@
 #include "math-sll.h"
 
-static void create_meta(lua_State *L);
-
 void push_Vector2(lua_State *L, sll x, sll y)
 {
 	Vector2* p = lua_newuserdata(L, sizeof(Vector2));
 	p->x = x;
 	p->y = y;
-	create_meta(L);
+	luaL_getmetatable(L, __VECTOR2_META__);
+	lua_setmetatable(L, -2);
+}
+
+// 同 push_Vector2, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+void push_Vector2_up(lua_State *L, sll x, sll y)
+{
+	Vector2* p = lua_newuserdata(L, sizeof(Vector2));
+	p->x = x;
+	p->y = y;
+	fix_push_meta_up(L, FIX_META_VEC2);
 	lua_setmetatable(L, -2);
 }
 
 sll vec2_dot(Vector2 *a, Vector2 *b)
 {
-	return slladd(sllmul(a->x, b->x), sllmul(a->y, b->y));
+	return slldot2(a->x, b->x, a->y, b->y);
 }
 
 sll vec2_sqrmagnitude(Vector2 *self)
 {
-	return slladd(sllmul(self->x, self->x), sllmul(self->y, self->y));
+	return sllmagsq2(self->x, self->y);
 }
 
 sll vec2_magnitude(Vector2 *self)
 {
-	return slld2dsqrt(vec2_sqrmagnitude(self));
+	return sllmag2(self->x, self->y);
 }
 
 sll vec2_cross(Vector2 *a, Vector2 *b)
@@ -38,13 +46,20 @@ void vec2_lerp(Vector2 *a, Vector2 *b, sll tt, Vector2 *out)
 	out->y = slladd(a->y , sllmul(sllsub(b->y, a->y), tt));
 }
 
+// 先按 2 的幂缩放到最大分量在 [1, 2), 平方和不会溢出也不会下溢,
+// 然后一次 rsqrt, 每个分量一次乘法
 void vec2_set_normalize(Vector2 * self)
 {
-	sll magnitude = vec2_magnitude(self);
-	if (magnitude > CONST_0)
+	ull ax = (self->x < 0) ? 0 - (ull)self->x : (ull)self->x;
+	ull ay = (self->y < 0) ? 0 - (ull)self->y : (ull)self->y;
+	int n = sllbitlen(ax > ay ? ax : ay) - 33;
+	if (n > -33)
 	{
-		self->x = slldiv(self->x, magnitude);
-		self->y = slldiv(self->y, magnitude);
+		sll x = (n > 0) ? self->x >> n : self->x << -n;
+		sll y = (n > 0) ? self->y >> n : self->y << -n;
+		sll r = sllrsqrt(slladd(sllmul(x, x), sllmul(y, y)));
+		self->x = sllmul(x, r);
+		self->y = sllmul(y, r);
 	}
 	else
 	{
@@ -72,7 +87,7 @@ static int New(lua_State *L)
 	}
 	round_x = (int)(x + (x > 0 ? 0.5 : -0.5));
 	round_y = (int)(y + (y > 0 ? 0.5 : -0.5));
-	push_Vector2(L, int2sll(round_x) / _mul[fn], int2sll(round_y) / _mul[fn]);
+	push_Vector2_up(L, int2sll(round_x) / _mul[fn], int2sll(round_y) / _mul[fn]);
 	return 1;
 }
 
@@ -80,42 +95,42 @@ static int NewFromFix(lua_State *L)
 {
 	check_set_fix(1, x);
 	check_set_fix(2, y);
-	push_Vector2(L, *x, *y);
+	push_Vector2_up(L, *x, *y);
 	return 1;	
 }
 
 static int NewFromVec3(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_Vector2(L, self->x, self->z);
+	push_Vector2_up(L, self->x, self->z);
 	return 1;	
 }
 
 static int NormalFromVec3(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_Vector2(L, sllneg(self->z), self->x);
+	push_Vector2_up(L, sllneg(self->z), self->x);
 	return 1;	
 }
 
 static int NormalFromVec2(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_Vector2(L, sllneg(self->y), self->x);
+	push_Vector2_up(L, sllneg(self->y), self->x);
 	return 1;	
 }
 
 static int get_x(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_fix(L, self->x);
+	push_fix_up(L, self->x);
 	return 1;	
 }
 
 static int get_y(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_fix(L, self->y);
+	push_fix_up(L, self->y);
 	return 1;	
 }
 
@@ -141,14 +156,14 @@ static int Set(lua_State *L)
 static int SqrMagnitude(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_fix(L, vec2_sqrmagnitude(self));
+	push_fix_up(L, vec2_sqrmagnitude(self));
 	return 1;
 }
 
 static int Clone(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_Vector2(L, self->x, self->y);
+	push_Vector2_up(L, self->x, self->y);
 	return 1;
 }
 
@@ -157,7 +172,7 @@ static int Normalize(lua_State *L)
 	check_set_vec2(1, self);
 	Vector2 ret = *self;
 	vec2_set_normalize(&ret);
-	push_Vector2(L, ret.x, ret.y);
+	push_Vector2_up(L, ret.x, ret.y);
 	return 1;
 }
 
@@ -173,7 +188,7 @@ static int Dot(lua_State *L)
 	check_set_vec2(1, a);
 	check_set_vec2(2, b);
 
-	push_fix(L, vec2_dot(a, b));
+	push_fix_up(L, vec2_dot(a, b));
 	return 1;
 }
 
@@ -181,7 +196,7 @@ static int Cross(lua_State *L)
 {
 	check_set_vec2(1, a);
 	check_set_vec2(2, b);
-	push_fix(L, vec2_cross(a, b));
+	push_fix_up(L, vec2_cross(a, b));
 	return 1;
 }
 
@@ -193,16 +208,24 @@ static int Angle(lua_State *L)
 	Vector2 _to = *to;
 	vec2_set_normalize(&_from);
 	vec2_set_normalize(&_to);
-	sll d = slladd(sllmul(_from.x, _to.x), sllmul(_from.y, _to.y));
+	sll d = vec2_dot(&_from, &_to);
 	d = clamp_fix(d, CONST_neg1, CONST_1);
-	push_fix(L, sllmul(sllacos(d), CONST_180_PI));
+	push_fix_up(L, sllmul(sllacos(d), CONST_180_PI));
 	return 1;
 }
 
 static int Magnitude(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_fix(L, vec2_magnitude(self));
+	push_fix_up(L, vec2_magnitude(self));
+	return 1;
+}
+
+static int Distance(lua_State *L)
+{
+	check_set_vec2(1, a);
+	check_set_vec2(2, b);
+	push_fix_up(L, sllmagd2(a->x, b->x, a->y, b->y));
 	return 1;
 }
 
@@ -210,7 +233,7 @@ static int SqrDistance(lua_State *L)
 {
 	check_set_vec2(1, a);
 	check_set_vec2(2, b);
-	push_fix(L, slladd(sllmul(a->x - b->x, a->x - b->x), sllmul(a->y - b->y, a->y - b->y)));
+	push_fix_up(L, sllmagsqd2(a->x, b->x, a->y, b->y));
 	return 1;
 }
 
@@ -221,7 +244,7 @@ static int Lerp(lua_State *L)
 	check_set_fix(3, t);
 	Vector2 ret;
 	vec2_lerp(a, b, *t, &ret);
-	push_Vector2(L, ret.x, ret.y);
+	push_Vector2_up(L, ret.x, ret.y);
 	return 1;
 }
 
@@ -232,7 +255,7 @@ static int LerpUnclamped(lua_State *L)
 	check_set_fix(3, t);
 	sll x = slladd(a->x , sllmul(sllsub(b->x, a->x), *t));
 	sll y = slladd(a->y , sllmul(sllsub(b->y, a->y), *t));
-	push_Vector2(L, x, y);
+	push_Vector2_up(L, x, y);
 	return 1;
 }
 
@@ -247,7 +270,7 @@ static int Max(lua_State *L)
 		max_x = max(max_x, a->x);
 		max_y = max(max_y, a->y);
 	}
-	push_Vector2(L, max_x, max_y);
+	push_Vector2_up(L, max_x, max_y);
 	return 1;
 }
 
@@ -262,14 +285,14 @@ static int Min(lua_State *L)
 		min_x = min(min_x, a->x);
 		min_y = min(min_y, a->y);
 	}
-	push_Vector2(L, min_x, min_y);
+	push_Vector2_up(L, min_x, min_y);
 	return 1;
 }
 
 static int Abs(lua_State *L)
 {
 	check_set_vec2(1, a);
-	push_Vector2(L, sllabs(a->x), sllabs(a->y));
+	push_Vector2_up(L, sllabs(a->x), sllabs(a->y));
 	return 1;	
 }
 
@@ -277,23 +300,42 @@ static int Scale(lua_State *L)
 {
 	check_set_vec2(1, a);
 	check_set_vec2(2, b);
-	push_Vector2(L, sllmul(a->x, b->x), sllmul(a->y, b->y));
+	push_Vector2_up(L, sllmul(a->x, b->x), sllmul(a->y, b->y));
 	return 1;
 }
 
+// d 可以是定点数或数, 整数时用 slldivi
 static int Div(lua_State *L)
 {
+	int n;
 	check_set_vec2(1, self);
-	check_set_fix(2, d);
-	push_Vector2(L, slldiv(self->x, *d), slldiv(self->y, *d));
+	if (fix_toint(L, 2, &n))
+	{
+		if (n == 0)
+		{
+			return luaL_error(L, "div zero!");
+		}
+		push_Vector2_up(L, slldivi(self->x, n), slldivi(self->y, n));
+		return 1;
+	}
+	check_get_fix(2, d);
+	push_Vector2_up(L, slldiv(self->x, d), slldiv(self->y, d));
 	return 1;
 }
 
+// v * d 或 d * v, d 可以是定点数或数, 整数时用 sllmuli
 static int Mul(lua_State *L)
 {
-	check_set_vec2(1, self);
-	check_set_fix(2, d);
-	push_Vector2(L, sllmul(self->x, *d), sllmul(self->y, *d));
+	int n;
+	int idx = fix_testudata(L, 1, FIX_META_VEC2, __VECTOR2_META__) ? 2 : 1;
+	check_set_vec2(3 - idx, self);
+	if (fix_toint(L, idx, &n))
+	{
+		push_Vector2_up(L, sllmuli(self->x, n), sllmuli(self->y, n));
+		return 1;
+	}
+	check_get_fix(idx, d);
+	push_Vector2_up(L, sllmul(self->x, d), sllmul(self->y, d));
 	return 1;
 }
 
@@ -301,7 +343,7 @@ static int Add(lua_State *L)
 {
 	check_set_vec2(1, self);
 	check_set_vec2(2, b);
-	push_Vector2(L, slladd(self->x, b->x), slladd(self->y, b->y));
+	push_Vector2_up(L, slladd(self->x, b->x), slladd(self->y, b->y));
 	return 1;
 }
 
@@ -309,7 +351,7 @@ static int AddFix(lua_State *L)
 {
 	check_set_vec2(1, self);
 	check_set_fix(2, b);
-	push_Vector2(L, slladd(self->x, *b), slladd(self->y, *b));
+	push_Vector2_up(L, slladd(self->x, *b), slladd(self->y, *b));
 	return 1;
 }
 
@@ -317,7 +359,7 @@ static int Sub(lua_State *L)
 {
 	check_set_vec2(1, self);
 	check_set_vec2(2, b);
-	push_Vector2(L, sllsub(self->x, b->x), sllsub(self->y, b->y));
+	push_Vector2_up(L, sllsub(self->x, b->x), sllsub(self->y, b->y));
 	return 1;
 }
 
@@ -325,14 +367,154 @@ static int SubFix(lua_State *L)
 {
 	check_set_vec2(1, self);
 	check_set_fix(2, b);
-	push_Vector2(L, sllsub(self->x, *b), sllsub(self->y, *b));
+	push_Vector2_up(L, sllsub(self->x, *b), sllsub(self->y, *b));
 	return 1;
 }
 
 static int Unm(lua_State *L)
 {
 	check_set_vec2(1, self);
-	push_Vector2(L, sllneg(self->x), sllneg(self->y));
+	push_Vector2_up(L, sllneg(self->x), sllneg(self->y));
+	return 1;
+}
+
+// ---------- 原地修改: 结果写回第一个参数并返回它, 不分配新的 userdata ----------
+
+static int AddInPlace(lua_State *L)
+{
+	check_set_vec2(1, self);
+	check_set_vec2(2, b);
+	self->x = slladd(self->x, b->x);
+	self->y = slladd(self->y, b->y);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int SubInPlace(lua_State *L)
+{
+	check_set_vec2(1, self);
+	check_set_vec2(2, b);
+	self->x = sllsub(self->x, b->x);
+	self->y = sllsub(self->y, b->y);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 同 Mul, 整数时用 sllmuli
+static int MulFixInPlace(lua_State *L)
+{
+	int n;
+	check_set_vec2(1, self);
+	if (fix_toint(L, 2, &n))
+	{
+		self->x = sllmuli(self->x, n);
+		self->y = sllmuli(self->y, n);
+	}
+	else
+	{
+		check_get_fix(2, d);
+		self->x = sllmul(self->x, d);
+		self->y = sllmul(self->y, d);
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 同 Div, 整数时用 slldivi
+static int DivFixInPlace(lua_State *L)
+{
+	int n;
+	check_set_vec2(1, self);
+	if (fix_toint(L, 2, &n))
+	{
+		if (n == 0)
+		{
+			return luaL_error(L, "div zero!");
+		}
+		self->x = slldivi(self->x, n);
+		self->y = slldivi(self->y, n);
+	}
+	else
+	{
+		check_get_fix(2, d);
+		self->x = slldiv(self->x, d);
+		self->y = slldiv(self->y, d);
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int ScaleInPlace(lua_State *L)
+{
+	check_set_vec2(1, self);
+	check_set_vec2(2, b);
+	self->x = sllmul(self->x, b->x);
+	self->y = sllmul(self->y, b->y);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int NegateInPlace(lua_State *L)
+{
+	check_set_vec2(1, self);
+	self->x = sllneg(self->x);
+	self->y = sllneg(self->y);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self = self + b * s, 例如 pos:AddScaledInPlace(vel, dt)
+static int AddScaledInPlace(lua_State *L)
+{
+	check_set_vec2(1, self);
+	check_set_vec2(2, b);
+	check_get_fix(3, s);
+	self->x = slladd(self->x, sllmul(b->x, s));
+	self->y = slladd(self->y, sllmul(b->y, s));
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int CopyFrom(lua_State *L)
+{
+	check_set_vec2(1, self);
+	check_set_vec2(2, b);
+	*self = *b;
+	lua_settop(L, 1);
+	return 1;
+}
+
+// out = Lerp(a, b, t), out 可以就是 a 或 b
+static int LerpInto(lua_State *L)
+{
+	check_set_vec2(1, out);
+	check_set_vec2(2, a);
+	check_set_vec2(3, b);
+	check_get_fix(4, t);
+	vec2_lerp(a, b, t, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int LerpUnclampedInto(lua_State *L)
+{
+	check_set_vec2(1, out);
+	check_set_vec2(2, a);
+	check_set_vec2(3, b);
+	check_get_fix(4, t);
+	out->x = slladd(a->x, sllmul(sllsub(b->x, a->x), t));
+	out->y = slladd(a->y, sllmul(sllsub(b->y, a->y), t));
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int NormalizeInto(lua_State *L)
+{
+	check_set_vec2(1, out);
+	check_set_vec2(2, a);
+	*out = *a;
+	vec2_set_normalize(out);
+	lua_settop(L, 1);
 	return 1;
 }
 
@@ -348,20 +530,20 @@ static int vec2_tostring(lua_State *L)
 {
 	char cons[64];
 	check_set_vec2(1, self);
-	sprintf(cons, "(%.6f,%.6f)", (double)self->x / (double)(CONST_1), (double)self->y / (double)(CONST_1));
-	lua_pushstring(L, cons);
+	sll v[2] = {self->x, self->y};
+	lua_pushlstring(L, cons, fix_format_tuple(cons, v, 2));
 	return 1;
 }
 
 static int to_number(lua_State *L)
 {
 	check_set_vec2(1, self);
-	lua_pushnumber(L, (double)(self->x) / (double)(CONST_1) );
-	lua_pushnumber(L, (double)(self->y) / (double)(CONST_1) );
+	lua_pushnumber(L, sll2dbl(self->x));
+	lua_pushnumber(L, sll2dbl(self->y));
 	return 2;
 }
 
-static const luaL_Reg lua_meta_methods[] = {
+const luaL_Reg lua_vec2_meta_methods[] = {
 	{"__add",   Add},
 	{"__sub",   Sub},
 	{"__mul",   Mul},
@@ -372,7 +554,7 @@ static const luaL_Reg lua_meta_methods[] = {
 	{NULL, NULL}
 };
 
-static const luaL_Reg lua_vec2_modules[] = {
+const luaL_Reg lua_vec2_modules[] = {
 	{"New",   New},
 	{"get_x", get_x},
 	{"get_y", get_y},
@@ -392,40 +574,41 @@ static const luaL_Reg lua_vec2_modules[] = {
 	{"Cross",   Cross},
 	{"Angle",   Angle},
 	{"Magnitude",   Magnitude},
+	{"Distance",   Distance},
+	{"SqrDistance",   SqrDistance},
 	{"Lerp",   Lerp},
 	{"LerpUnclamped",   LerpUnclamped},
 	{"Min",   Min},
 	{"Max",   Max},
 	{"Scale",   Scale},
 	{"tonumber",   to_number},
+	{"AddInPlace",   AddInPlace},
+	{"SubInPlace",   SubInPlace},
+	{"MulFixInPlace",   MulFixInPlace},
+	{"DivFixInPlace",   DivFixInPlace},
+	{"ScaleInPlace",   ScaleInPlace},
+	{"NegateInPlace",   NegateInPlace},
+	{"AddScaledInPlace",   AddScaledInPlace},
+	{"CopyFrom",   CopyFrom},
+	{"LerpInto",   LerpInto},
+	{"LerpUnclampedInto",   LerpUnclampedInto},
+	{"NormalizeInto",   NormalizeInto},
 	{NULL, NULL}
 };
 
-static void fill_meta(lua_State *L)
-{
-	luaL_setfuncs(L, lua_meta_methods, 0);
-	luaL_newlib(L, lua_vec2_modules);
-  	lua_setfield(L, -2, "__index");
-}
-
-static void create_meta(lua_State *L)
-{
-	if(luaL_newmetatable (L, __VECTOR2_META__) != 0)
-	{
-		fill_meta(L);
-	}
-}
-
 LUALIB_API int luaopen_fix_vec2(lua_State* L)
 {
 #ifdef luaL_checkversion
 	luaL_checkversion(L);
 #endif
 #if LUA_VERSION_NUM < 502
-    luaL_register(L, "fix_vec2", lua_vec2_modules);
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_vec2", lua_vec2_modules, FIX_META_COUNT);
 #else
     // 这个傻叉函数，在5.3以前实际是new了一个新的table，然后setfunc，其实没注册到loaded
-    luaL_newlib(L, lua_vec2_modules);
+    luaL_newlibtable(L, lua_vec2_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_vec2_modules, FIX_META_COUNT);
 #endif
 	return 1;
 }
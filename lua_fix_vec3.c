@@ -1,25 +1,34 @@
 #include "math-sll.h"
 
-static void create_meta(lua_State *L);
-
 void push_Vector3(lua_State *L, sll x, sll y, sll z)
 {
 	Vector3* p = lua_newuserdata(L, sizeof(Vector3));
 	p->x = x;
 	p->y = y;
 	p->z = z;
-	create_meta(L);
+	luaL_getmetatable(L, __VECTOR3_META__);
+	lua_setmetatable(L, -2);
+}
+
+// 同 push_Vector3, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+void push_Vector3_up(lua_State *L, sll x, sll y, sll z)
+{
+	Vector3* p = lua_newuserdata(L, sizeof(Vector3));
+	p->x = x;
+	p->y = y;
+	p->z = z;
+	fix_push_meta_up(L, FIX_META_VEC3);
 	lua_setmetatable(L, -2);
 }
 
 sll vec3_magnitude(Vector3* self)
 {
-	return slld2dsqrt( slladd(sllmul(self->x, self->x), slladd(sllmul(self->y, self->y), sllmul(self->z, self->z))) );
+	return sllmag3(self->x, self->y, self->z);
 }
 
 sll vec3_dot(Vector3 *a, Vector3 *b)
 {
-	return slladd(sllmul(a->x, b->x), slladd(sllmul(a->y, b->y), sllmul(a->z, b->z)));
+	return slldot3(a->x, b->x, a->y, b->y, a->z, b->z);
 }
 
 void vec3_cross(Vector3 * a, Vector3 *b, Vector3 *out)
@@ -37,14 +46,24 @@ void vec3_lerp(Vector3 *a, Vector3 *b, sll tt, Vector3 *out)
 	out->z = slladd(a->z , sllmul(sllsub(b->z, a->z), tt));
 }
 
+// 先按 2 的幂缩放到最大分量在 [1, 2), 平方和不会溢出也不会下溢,
+// 然后一次 rsqrt, 每个分量一次乘法
 void vec3_set_normalize(Vector3 * self)
 {
-	sll magnitude = vec3_magnitude(self);
-	if (magnitude > CONST_0)
+	ull ax = (self->x < 0) ? 0 - (ull)self->x : (ull)self->x;
+	ull ay = (self->y < 0) ? 0 - (ull)self->y : (ull)self->y;
+	ull az = (self->z < 0) ? 0 - (ull)self->z : (ull)self->z;
+	ull am = ax > ay ? ax : ay;
+	int n = sllbitlen(am > az ? am : az) - 33;
+	if (n > -33)
 	{
-		self->x = slldiv(self->x, magnitude);
-		self->y = slldiv(self->y, magnitude);
-		self->z = slldiv(self->z, magnitude);
+		sll x = (n > 0) ? self->x >> n : self->x << -n;
+		sll y = (n > 0) ? self->y >> n : self->y << -n;
+		sll z = (n > 0) ? self->z >> n : self->z << -n;
+		sll r = sllrsqrt(slladd(sllmul(x, x), slladd(sllmul(y, y), sllmul(z, z))));
+		self->x = sllmul(x, r);
+		self->y = sllmul(y, r);
+		self->z = sllmul(z, r);
 	}
 	else
 	{
@@ -76,7 +95,7 @@ static int New(lua_State *L)
 	round_x = (int)(x + (x > 0 ? 0.5 : -0.5));
 	round_y = (int)(y + (y > 0 ? 0.5 : -0.5));
 	round_z = (int)(z + (z > 0 ? 0.5 : -0.5));
-	push_Vector3(L, int2sll(round_x) / _mul[fn], int2sll(round_y) / _mul[fn], int2sll(round_z) / _mul[fn]);
+	push_Vector3_up(L, int2sll(round_x) / _mul[fn], int2sll(round_y) / _mul[fn], int2sll(round_z) / _mul[fn]);
 	return 1;
 }
 
@@ -85,49 +104,49 @@ static int NewFromFix(lua_State *L)
 	check_set_fix(1, x);
 	check_set_fix(2, y);
 	check_set_fix(3, z);
-	push_Vector3(L, *x, *y, *z);
+	push_Vector3_up(L, *x, *y, *z);
 	return 1;	
 }
 
 static int NewFromVec2(lua_State *L)
 {
 	check_set_vec2(1, a);
-	push_Vector3(L, a->x, CONST_0, a->y);
+	push_Vector3_up(L, a->x, CONST_0, a->y);
 	return 1;	
 }
 
 static int NormalFromVec3(lua_State *L)
 {
 	check_set_vec3(1, a);
-	push_Vector3(L, sllneg(a->z), CONST_0, a->x);
+	push_Vector3_up(L, sllneg(a->z), CONST_0, a->x);
 	return 1;	
 }
 
 static int Abs(lua_State *L)
 {
 	check_set_vec3(1, a);
-	push_Vector3(L, sllabs(a->x), sllabs(a->y), sllabs(a->z));
+	push_Vector3_up(L, sllabs(a->x), sllabs(a->y), sllabs(a->z));
 	return 1;	
 }
 
 static int get_x(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, self->x);
+	push_fix_up(L, self->x);
 	return 1;	
 }
 
 static int get_y(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, self->y);
+	push_fix_up(L, self->y);
 	return 1;	
 }
 
 static int get_z(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, self->z);
+	push_fix_up(L, self->z);
 	return 1;	
 }
 
@@ -157,28 +176,28 @@ static int Set(lua_State *L)
 static int SqrMagnitude(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, vec3_dot(self, self));
+	push_fix_up(L, sllmagsq3(self->x, self->y, self->z));
 	return 1;
 }
 
 static int Vec2SqrMagnitude(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, slladd(sllmul(self->x, self->x), sllmul(self->z, self->z)));
+	push_fix_up(L, sllmagsq2(self->x, self->z));
 	return 1;
 }
 
 static int Clone(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_Vector3(L, self->x, self->y, self->z);
+	push_Vector3_up(L, self->x, self->y, self->z);
 	return 1;
 }
 
 static int CloneZeroY(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_Vector3(L, self->x, CONST_0, self->z);
+	push_Vector3_up(L, self->x, CONST_0, self->z);
 	return 1;
 }
 
@@ -186,10 +205,7 @@ static int Distance(lua_State *L)
 {
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
-	push_fix(L, slld2dsqrt(slladd(
-		sllmul(a->x - b->x, a->x - b->x), 
-		slladd(sllmul(a->y - b->y, a->y - b->y),
-		sllmul(a->z - b->z, a->z - b->z)))));
+	push_fix_up(L, sllmagd3(a->x, b->x, a->y, b->y, a->z, b->z));
 	return 1;
 }
 
@@ -197,9 +213,7 @@ static int Vec2Distance(lua_State *L)
 {
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
-	push_fix(L, slld2dsqrt(slladd(
-		sllmul(a->x - b->x, a->x - b->x),
-		sllmul(a->z - b->z, a->z - b->z))));
+	push_fix_up(L, sllmagd2(a->x, b->x, a->z, b->z));
 	return 1;
 }
 
@@ -207,9 +221,7 @@ static int Vec2SqrDistance(lua_State *L)
 {
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
-	push_fix(L, slladd(
-		sllmul(a->x - b->x, a->x - b->x),
-		sllmul(a->z - b->z, a->z - b->z)));
+	push_fix_up(L, sllmagsqd2(a->x, b->x, a->z, b->z));
 	return 1;
 }
 
@@ -218,7 +230,7 @@ static int Normalize(lua_State *L)
 	check_set_vec3(1, self);
 	Vector3 ret = *self;
 	vec3_set_normalize(&ret);
-	push_Vector3(L, ret.x, ret.y, ret.z);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
 	return 1;
 }
 
@@ -234,7 +246,7 @@ static int Dot(lua_State *L)
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
 
-	push_fix(L, vec3_dot(a, b));
+	push_fix_up(L, vec3_dot(a, b));
 	return 1;
 }
 
@@ -243,7 +255,7 @@ static int Vec2Dot(lua_State *L)
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
 
-	push_fix(L, slladd(sllmul(a->x, b->x), sllmul(a->z, b->z)));
+	push_fix_up(L, slldot2(a->x, b->x, a->z, b->z));
 	return 1;
 }
 
@@ -253,7 +265,7 @@ static int Cross(lua_State *L)
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
 	vec3_cross(a, b, &out);
-	push_Vector3(L, out.x, out.y, out.z);
+	push_Vector3_up(L, out.x, out.y, out.z);
 	return 1;
 }
 
@@ -261,7 +273,7 @@ static int Vec2Cross(lua_State *L)
 {
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
-	push_fix(L, sllsub(sllmul(a->x, b->z), sllmul(a->z, b->x)));
+	push_fix_up(L, sllsub(sllmul(a->x, b->z), sllmul(a->z, b->x)));
 	return 1;
 }
 
@@ -273,29 +285,29 @@ static int Angle(lua_State *L)
 	vec3_set_normalize(to);
 	sll d = vec3_dot(from, to);
 	d = clamp_fix(d, CONST_neg1, CONST_1);
-	push_fix(L, sllmul(sllacos(d), CONST_180_PI));
+	push_fix_up(L, sllmul(sllacos(d), CONST_180_PI));
 	return 1;
 }
 
 static int Magnitude(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, vec3_magnitude(self));
+	push_fix_up(L, vec3_magnitude(self));
 	return 1;
 }
 
 static int Vec2Magnitude(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_fix(L, slld2dsqrt(slladd(sllmul(self->x, self->x), sllmul(self->z, self->z))));
+	push_fix_up(L, sllmag2(self->x, self->z));
 	return 1;
 }
 
 static int SqrDistance(lua_State *L)
 {
-	check_set_vec2(1, a);
-	check_set_vec2(2, b);
-	push_fix(L, slladd(sllmul(a->x - b->x, a->x - b->x), sllmul(a->y - b->y, a->y - b->y)));
+	check_set_vec3(1, a);
+	check_set_vec3(2, b);
+	push_fix_up(L, sllmagsqd3(a->x, b->x, a->y, b->y, a->z, b->z));
 	return 1;
 }
 
@@ -306,7 +318,7 @@ static int Lerp(lua_State *L)
 	check_set_fix(3, t);
 	Vector3 ret;
 	vec3_lerp(a, b, *t, &ret);
-	push_Vector3(L, ret.x, ret.y, ret.z);
+	push_Vector3_up(L, ret.x, ret.y, ret.z);
 	return 1;
 }
 
@@ -318,7 +330,7 @@ static int LerpUnclamped(lua_State *L)
 	sll x = slladd(a->x , sllmul(sllsub(b->x, a->x), *t));
 	sll y = slladd(a->y , sllmul(sllsub(b->y, a->y), *t));
 	sll z = slladd(a->z , sllmul(sllsub(b->z, a->z), *t));
-	push_Vector3(L, x, y, z);
+	push_Vector3_up(L, x, y, z);
 	return 1;
 }
 
@@ -326,23 +338,42 @@ static int Scale(lua_State *L)
 {
 	check_set_vec3(1, a);
 	check_set_vec3(2, b);
-	push_Vector3(L, sllmul(a->x, b->x), sllmul(a->y, b->y), sllmul(a->z, b->z));
+	push_Vector3_up(L, sllmul(a->x, b->x), sllmul(a->y, b->y), sllmul(a->z, b->z));
 	return 1;
 }
 
+// d 可以是定点数或数, 整数时用 slldivi
 static int Div(lua_State *L)
 {
+	int n;
 	check_set_vec3(1, self);
-	check_set_fix(2, d);
-	push_Vector3(L, slldiv(self->x, *d), slldiv(self->y, *d), slldiv(self->z, *d));
+	if (fix_toint(L, 2, &n))
+	{
+		if (n == 0)
+		{
+			return luaL_error(L, "div zero!");
+		}
+		push_Vector3_up(L, slldivi(self->x, n), slldivi(self->y, n), slldivi(self->z, n));
+		return 1;
+	}
+	check_get_fix(2, d);
+	push_Vector3_up(L, slldiv(self->x, d), slldiv(self->y, d), slldiv(self->z, d));
 	return 1;
 }
 
+// v * d 或 d * v, d 可以是定点数或数, 整数时用 sllmuli
 static int Mul(lua_State *L)
 {
-	check_set_vec3(1, self);
-	check_set_fix(2, d);
-	push_Vector3(L, sllmul(self->x, *d), sllmul(self->y, *d), sllmul(self->z, *d));
+	int n;
+	int idx = fix_testudata(L, 1, FIX_META_VEC3, __VECTOR3_META__) ? 2 : 1;
+	check_set_vec3(3 - idx, self);
+	if (fix_toint(L, idx, &n))
+	{
+		push_Vector3_up(L, sllmuli(self->x, n), sllmuli(self->y, n), sllmuli(self->z, n));
+		return 1;
+	}
+	check_get_fix(idx, d);
+	push_Vector3_up(L, sllmul(self->x, d), sllmul(self->y, d), sllmul(self->z, d));
 	return 1;
 }
 
@@ -350,7 +381,7 @@ static int Add(lua_State *L)
 {
 	check_set_vec3(1, self);
 	check_set_vec3(2, b);
-	push_Vector3(L, slladd(self->x, b->x), slladd(self->y, b->y), slladd(self->z, b->z));
+	push_Vector3_up(L, slladd(self->x, b->x), slladd(self->y, b->y), slladd(self->z, b->z));
 	return 1;
 }
 
@@ -368,7 +399,7 @@ static int AddFix(lua_State *L)
 {
 	check_set_vec3(1, self);
 	check_set_fix(2, b);
-	push_Vector3(L, slladd(self->x, *b), slladd(self->y, *b), slladd(self->z, *b));
+	push_Vector3_up(L, slladd(self->x, *b), slladd(self->y, *b), slladd(self->z, *b));
 	return 1;
 }
 
@@ -376,7 +407,7 @@ static int Sub(lua_State *L)
 {
 	check_set_vec3(1, self);
 	check_set_vec3(2, b);
-	push_Vector3(L, sllsub(self->x, b->x), sllsub(self->y, b->y), sllsub(self->z, b->z));
+	push_Vector3_up(L, sllsub(self->x, b->x), sllsub(self->y, b->y), sllsub(self->z, b->z));
 	return 1;
 }
 
@@ -384,14 +415,177 @@ static int SubFix(lua_State *L)
 {
 	check_set_vec3(1, self);
 	check_set_fix(2, b);
-	push_Vector3(L, sllsub(self->x, *b), sllsub(self->y, *b), sllsub(self->z, *b));
+	push_Vector3_up(L, sllsub(self->x, *b), sllsub(self->y, *b), sllsub(self->z, *b));
 	return 1;
 }
 
 static int Unm(lua_State *L)
 {
 	check_set_vec3(1, self);
-	push_Vector3(L, sllneg(self->x), sllneg(self->y), sllneg(self->z));
+	push_Vector3_up(L, sllneg(self->x), sllneg(self->y), sllneg(self->z));
+	return 1;
+}
+
+// ---------- 原地修改: 结果写回第一个参数并返回它, 不分配新的 userdata ----------
+
+static int AddInPlace(lua_State *L)
+{
+	check_set_vec3(1, self);
+	check_set_vec3(2, b);
+	self->x = slladd(self->x, b->x);
+	self->y = slladd(self->y, b->y);
+	self->z = slladd(self->z, b->z);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int SubInPlace(lua_State *L)
+{
+	check_set_vec3(1, self);
+	check_set_vec3(2, b);
+	self->x = sllsub(self->x, b->x);
+	self->y = sllsub(self->y, b->y);
+	self->z = sllsub(self->z, b->z);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 同 Mul, 整数时用 sllmuli
+static int MulFixInPlace(lua_State *L)
+{
+	int n;
+	check_set_vec3(1, self);
+	if (fix_toint(L, 2, &n))
+	{
+		self->x = sllmuli(self->x, n);
+		self->y = sllmuli(self->y, n);
+		self->z = sllmuli(self->z, n);
+	}
+	else
+	{
+		check_get_fix(2, d);
+		self->x = sllmul(self->x, d);
+		self->y = sllmul(self->y, d);
+		self->z = sllmul(self->z, d);
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+// 同 Div, 整数时用 slldivi
+static int DivFixInPlace(lua_State *L)
+{
+	int n;
+	check_set_vec3(1, self);
+	if (fix_toint(L, 2, &n))
+	{
+		if (n == 0)
+		{
+			return luaL_error(L, "div zero!");
+		}
+		self->x = slldivi(self->x, n);
+		self->y = slldivi(self->y, n);
+		self->z = slldivi(self->z, n);
+	}
+	else
+	{
+		check_get_fix(2, d);
+		self->x = slldiv(self->x, d);
+		self->y = slldiv(self->y, d);
+		self->z = slldiv(self->z, d);
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int ScaleInPlace(lua_State *L)
+{
+	check_set_vec3(1, self);
+	check_set_vec3(2, b);
+	self->x = sllmul(self->x, b->x);
+	self->y = sllmul(self->y, b->y);
+	self->z = sllmul(self->z, b->z);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int NegateInPlace(lua_State *L)
+{
+	check_set_vec3(1, self);
+	self->x = sllneg(self->x);
+	self->y = sllneg(self->y);
+	self->z = sllneg(self->z);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self = self + b * s, 例如 pos:AddScaledInPlace(vel, dt)
+static int AddScaledInPlace(lua_State *L)
+{
+	check_set_vec3(1, self);
+	check_set_vec3(2, b);
+	check_get_fix(3, s);
+	self->x = slladd(self->x, sllmul(b->x, s));
+	self->y = slladd(self->y, sllmul(b->y, s));
+	self->z = slladd(self->z, sllmul(b->z, s));
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int CopyFrom(lua_State *L)
+{
+	check_set_vec3(1, self);
+	check_set_vec3(2, b);
+	*self = *b;
+	lua_settop(L, 1);
+	return 1;
+}
+
+// out = Lerp(a, b, t), out 可以就是 a 或 b
+static int LerpInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_vec3(2, a);
+	check_set_vec3(3, b);
+	check_get_fix(4, t);
+	vec3_lerp(a, b, t, out);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int LerpUnclampedInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_vec3(2, a);
+	check_set_vec3(3, b);
+	check_get_fix(4, t);
+	out->x = slladd(a->x, sllmul(sllsub(b->x, a->x), t));
+	out->y = slladd(a->y, sllmul(sllsub(b->y, a->y), t));
+	out->z = slladd(a->z, sllmul(sllsub(b->z, a->z), t));
+	lua_settop(L, 1);
+	return 1;
+}
+
+// out = Cross(a, b), out 可以就是 a 或 b
+static int CrossInto(lua_State *L)
+{
+	Vector3 ret;
+	check_set_vec3(1, out);
+	check_set_vec3(2, a);
+	check_set_vec3(3, b);
+	vec3_cross(a, b, &ret);
+	*out = ret;
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int NormalizeInto(lua_State *L)
+{
+	check_set_vec3(1, out);
+	check_set_vec3(2, a);
+	*out = *a;
+	vec3_set_normalize(out);
+	lua_settop(L, 1);
 	return 1;
 }
 
@@ -405,24 +599,23 @@ static int Equal(lua_State *L)
 
 static int vec3_tostring(lua_State *L)
 {
-	char cons[128];
+	char cons[64];
 	check_set_vec3(1, self);
-	sprintf(cons, "(%.6f,%.6f,%.6f)", (double)self->x / (double)(CONST_1), 
-		(double)self->y / (double)(CONST_1), (double)self->z / (double)(CONST_1));
-	lua_pushstring(L, cons);
+	sll v[3] = {self->x, self->y, self->z};
+	lua_pushlstring(L, cons, fix_format_tuple(cons, v, 3));
 	return 1;
 }
 
 static int to_number(lua_State *L)
 {
 	check_set_vec3(1, self);
-	lua_pushnumber(L, (double)(self->x) / (double)(CONST_1) );
-	lua_pushnumber(L, (double)(self->y) / (double)(CONST_1) );
-	lua_pushnumber(L, (double)(self->z) / (double)(CONST_1) );
+	lua_pushnumber(L, sll2dbl(self->x));
+	lua_pushnumber(L, sll2dbl(self->y));
+	lua_pushnumber(L, sll2dbl(self->z));
 	return 3;
 }
 
-static const luaL_Reg lua_meta_methods[] = {
+const luaL_Reg lua_vec3_meta_methods[] = {
 	{"__add",   Add},
 	{"__sub",   Sub},
 	{"__mul",   Mul},
@@ -433,7 +626,7 @@ static const luaL_Reg lua_meta_methods[] = {
 	{NULL, NULL}
 };
 
-static const luaL_Reg lua_vec3_modules[] = {
+const luaL_Reg lua_vec3_modules[] = {
 	{"New",   New},
 	{"NewFromFix",   NewFromFix},
 	{"NewFromVec2",   NewFromVec2},
@@ -468,34 +661,34 @@ static const luaL_Reg lua_vec3_modules[] = {
 	{"LerpUnclamped",   LerpUnclamped},
 	{"Scale",   Scale},
 	{"tonumber",   to_number},
+	{"AddInPlace",   AddInPlace},
+	{"SubInPlace",   SubInPlace},
+	{"MulFixInPlace",   MulFixInPlace},
+	{"DivFixInPlace",   DivFixInPlace},
+	{"ScaleInPlace",   ScaleInPlace},
+	{"NegateInPlace",   NegateInPlace},
+	{"AddScaledInPlace",   AddScaledInPlace},
+	{"CopyFrom",   CopyFrom},
+	{"LerpInto",   LerpInto},
+	{"LerpUnclampedInto",   LerpUnclampedInto},
+	{"CrossInto",   CrossInto},
+	{"NormalizeInto",   NormalizeInto},
 	{NULL, NULL}
 };
 
-static void fill_meta(lua_State *L)
-{
-	luaL_setfuncs(L, lua_meta_methods, 0);
-	luaL_newlib(L, lua_vec3_modules);
-  	lua_setfield(L, -2, "__index");
-}
-
-static void create_meta(lua_State *L)
-{
-	if(luaL_newmetatable (L, __VECTOR3_META__) != 0)
-	{
-		fill_meta(L);
-	}
-}
-
 LUALIB_API int luaopen_fix_vec3(lua_State* L)
 {
 #ifdef luaL_checkversion
 	luaL_checkversion(L);
 #endif
 #if LUA_VERSION_NUM < 502
-    luaL_register(L, "fix_vec3", lua_vec3_modules);
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_vec3", lua_vec3_modules, FIX_META_COUNT);
 #else
     // 这个傻叉函数，在5.3以前实际是new了一个新的table，然后setfunc，其实没注册到loaded
-    luaL_newlib(L, lua_vec3_modules);
+    luaL_newlibtable(L, lua_vec3_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_vec3_modules, FIX_META_COUNT);
 #endif
 	return 1;
 }
@@ -0,0 +1,260 @@
+#include "math-sll.h"
+#include <limits.h>
+#include <string.h>
+
+/*
+	fix_vec3_array: n 个 Vector3 按分量分开存 (x[n], y[n], z[n])
+	批量的运算一次 C 调用处理整个数组, 不分配 userdata
+	逐元素的结果和 fix_vec3 的同名运算完全一致
+*/
+
+// 三条 lane 紧跟在 FixVec3Array 后面, 一次分配
+FixVec3Array *push_FixVec3Array(lua_State *L, int n)
+{
+	FixVec3Array* p = lua_newuserdata(L, sizeof(FixVec3Array) + 3 * (size_t)n * sizeof(sll));
+	p->n = n;
+	p->x = (sll *)(p + 1);
+	p->y = p->x + n;
+	p->z = p->y + n;
+	memset(p->x, 0, 3 * (size_t)n * sizeof(sll));
+	luaL_getmetatable(L, __VECTOR3_ARRAY_META__);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// 同 push_FixVec3Array, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+FixVec3Array *push_FixVec3Array_up(lua_State *L, int n)
+{
+	FixVec3Array* p = lua_newuserdata(L, sizeof(FixVec3Array) + 3 * (size_t)n * sizeof(sll));
+	p->n = n;
+	p->x = (sll *)(p + 1);
+	p->y = p->x + n;
+	p->z = p->y + n;
+	memset(p->x, 0, 3 * (size_t)n * sizeof(sll));
+	fix_push_meta_up(L, FIX_META_VEC3_ARRAY);
+	lua_setmetatable(L, -2);
+	return p;
+}
+
+// Lua 下标从 1 开始, 返回 C 下标
+static int check_index(lua_State *L, int idx, int n)
+{
+	lua_Integer i = luaL_checkinteger(L, idx);
+	luaL_argcheck(L, i >= 1 && i <= n, idx, "下标越界");
+	return (int)(i - 1);
+}
+
+static void get_vec3(FixVec3Array *self, int i, Vector3 *out)
+{
+	out->x = self->x[i];
+	out->y = self->y[i];
+	out->z = self->z[i];
+}
+
+static void set_vec3(FixVec3Array *self, int i, Vector3 *v)
+{
+	self->x[i] = v->x;
+	self->y[i] = v->y;
+	self->z[i] = v->z;
+}
+
+static int New(lua_State *L)
+{
+	lua_Integer n = luaL_checkinteger(L, 1);
+	luaL_argcheck(L, n >= 0 && n <= (lua_Integer)(INT_MAX / (3 * sizeof(sll))) - 1, 1, "长度不对");
+	push_FixVec3Array_up(L, (int)n);
+	return 1;
+}
+
+static int Size(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	lua_pushinteger(L, self->n);
+	return 1;
+}
+
+static int Get(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	int i = check_index(L, 2, self->n);
+	push_Vector3_up(L, self->x[i], self->y[i], self->z[i]);
+	return 1;
+}
+
+// 读到已有的 fix_vec3 里, 不分配
+static int GetInto(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	int i = check_index(L, 2, self->n);
+	check_set_vec3(3, out);
+	get_vec3(self, i, out);
+	lua_settop(L, 3);
+	return 1;
+}
+
+static int Set(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	int i = check_index(L, 2, self->n);
+	check_set_vec3(3, v);
+	set_vec3(self, i, v);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int CopyFrom(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_vec3_array(2, b);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	memmove(self->x, b->x, 3 * (size_t)self->n * sizeof(sll));
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] + v[i] * dt, 例如 pos:Axpy(vel, dt)
+static int Axpy(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_vec3_array(2, v);
+	check_set_fix(3, dt);
+	luaL_argcheck(L, v->n == self->n, 2, "长度不一致");
+	sllaxpy_array(v->x, *dt, self->x, self->n);
+	sllaxpy_array(v->y, *dt, self->y, self->n);
+	sllaxpy_array(v->z, *dt, self->z, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] + b[i]
+static int Add(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_vec3_array(2, b);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	slladd_array(b->x, self->x, self->n);
+	slladd_array(b->y, self->y, self->n);
+	slladd_array(b->z, self->z, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = self[i] * s
+static int Scale(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_fix(2, s);
+	sllscale_array(*s, self->x, self->n);
+	sllscale_array(*s, self->y, self->n);
+	sllscale_array(*s, self->z, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+// self[i] = Lerp(self[i], b[i], t), t 限制在 [0, 1]
+static int Lerp(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_vec3_array(2, b);
+	check_set_fix(3, t);
+	luaL_argcheck(L, b->n == self->n, 2, "长度不一致");
+	sll tt = clamp_fix(*t, CONST_0, CONST_1);
+	slllerp_array(b->x, tt, self->x, self->n);
+	slllerp_array(b->y, tt, self->y, self->n);
+	slllerp_array(b->z, tt, self->z, self->n);
+	lua_settop(L, 1);
+	return 1;
+}
+
+static int NormalizeAll(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	Vector3 e;
+	for (int i = 0; i < self->n; i++)
+	{
+		get_vec3(self, i, &e);
+		vec3_set_normalize(&e);
+		set_vec3(self, i, &e);
+	}
+	lua_settop(L, 1);
+	return 1;
+}
+
+// out[i] = Dot(self[i], v), out 是 fix_array
+static int DotWith(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_vec3(2, v);
+	check_set_fix_array(3, out);
+	luaL_argcheck(L, out->n == self->n, 3, "长度不一致");
+	Vector3 e;
+	for (int i = 0; i < self->n; i++)
+	{
+		get_vec3(self, i, &e);
+		out->v[i] = vec3_dot(&e, v);
+	}
+	lua_settop(L, 3);
+	return 1;
+}
+
+// out[i] = Magnitude(self[i]), out 是 fix_array
+static int MagnitudeAll(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	check_set_fix_array(2, out);
+	luaL_argcheck(L, out->n == self->n, 2, "长度不一致");
+	Vector3 e;
+	for (int i = 0; i < self->n; i++)
+	{
+		get_vec3(self, i, &e);
+		out->v[i] = vec3_magnitude(&e);
+	}
+	lua_settop(L, 2);
+	return 1;
+}
+
+static int vec3_array_tostring(lua_State *L)
+{
+	check_set_vec3_array(1, self);
+	lua_pushfstring(L, "fix_vec3_array(%d)", self->n);
+	return 1;
+}
+
+const luaL_Reg lua_vec3_array_meta_methods[] = {
+	{"__len",   Size},
+	{"__tostring",   vec3_array_tostring},
+	{NULL, NULL}
+};
+
+const luaL_Reg lua_vec3_array_modules[] = {
+	{"New",   New},
+	{"Size",   Size},
+	{"Get",   Get},
+	{"GetInto",   GetInto},
+	{"Set",   Set},
+	{"CopyFrom",   CopyFrom},
+	{"Axpy",   Axpy},
+	{"Add",   Add},
+	{"Scale",   Scale},
+	{"Lerp",   Lerp},
+	{"NormalizeAll",   NormalizeAll},
+	{"DotWith",   DotWith},
+	{"MagnitudeAll",   MagnitudeAll},
+	{NULL, NULL}
+};
+
+LUALIB_API int luaopen_fix_vec3_array(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+#if LUA_VERSION_NUM < 502
+    fix_push_metatables(L);
+    luaL_openlib(L, "fix_vec3_array", lua_vec3_array_modules, FIX_META_COUNT);
+#else
+    luaL_newlibtable(L, lua_vec3_array_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_vec3_array_modules, FIX_META_COUNT);
+#endif
+	return 1;
+}
@@ -5,47 +5,193 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <errno.h>
-
-static void create_meta(lua_State *L);
+#include <limits.h>
 
 void push_fix(lua_State *L, sll v)
 {
 	sll* p = lua_newuserdata(L, sizeof(v));
 	*p = v;
-	create_meta(L);
+	luaL_getmetatable(L, __METATABLE_NAME);
 	lua_setmetatable(L, -2);
 }
 
-static int l_tofix(lua_State *L)
+// 同 push_fix, 但元表取自 upvalue, 只能在注册给 Lua 的函数里调用
+void push_fix_up(lua_State *L, sll v)
 {
-	lua_settop(L, 2);
-	sll* p = luaL_testudata(L, 1, __METATABLE_NAME);
-	if(p)
+	sll* p = lua_newuserdata(L, sizeof(v));
+	*p = v;
+	fix_push_meta_up(L, FIX_META_FIX);
+	lua_setmetatable(L, -2);
+}
+
+/*
+	按 tofix 的规则把 idx 处的 number 转成定点数, len_idx 处是小数位数(0-6)
+	出错时直接 luaL_error
+*/
+sll fix_checkdecimal(lua_State *L, int idx, int len_idx)
+{
+	double val = (double)luaL_checknumber(L, idx);
+	int round_val;
+	int len = (int)luaL_optinteger(L, len_idx, 0);
+	if (len > 6 || len < 0)
 	{
-		push_fix(L, *p);
+		return luaL_error(L, "转换为定点数只支持0-6位小数精度");
 	}
-	else
+	val = val * _mul[len];
+	if (val >= 1000000000)
+	{
+		return luaL_error(L, "有效数字太多转不了，自己看着办");
+	}
+	round_val = (int)(val + (val > 0 ? 0.5 : -0.5));
+	if (fabs(val - round_val) > 0.2)
 	{
-		double val = (double)luaL_checknumber(L, 1);
-		int round_val;
-		int len = (int)luaL_optinteger(L, 2, 0);
-		if (len > 6 || len < 0)
+		return luaL_error(L, "第%d位小数怎么还有值？", len + 1);
+	}
+	// 这里可以直接除整数
+	return int2sll(round_val) / _mul[len];
+}
+
+/*
+	idx 处是定点数, Lua 整数, 或者能精确表示成定点数的 Lua 浮点数时转换到 *out, 返回 1
+	整数走 int2sll, 不经过 double; 其他情况返回 0
+*/
+int fix_tosll(lua_State *L, int idx, sll *out)
+{
+	sll *p = fix_testudata(L, idx, FIX_META_FIX, __METATABLE_NAME);
+	if (p)
+	{
+		*out = *p;
+		return 1;
+	}
+	if (lua_type(L, idx) != LUA_TNUMBER)
+	{
+		return 0;
+	}
+	int n;
+	if (fix_toint(L, idx, &n))
+	{
+		*out = int2sll(n);
+		return 1;
+	}
+	// 乘 2^32 不会丢精度, 结果是范围内的整数就说明能精确表示; NaN 两个比较都不成立
+	double d = (double)lua_tonumber(L, idx) * 4294967296.0;
+	if (!(d >= -9223372036854775808.0 && d < 9223372036854775808.0) || d != floor(d))
+	{
+		return 0;
+	}
+	*out = (sll)d;
+	return 1;
+}
+
+/*
+	idx 处是 int 范围内的整数时写入 *n, 返回 1
+	5.3 以前没有整数类型, 值为整数的 number 也算
+*/
+int fix_toint(lua_State *L, int idx, int *n)
+{
+#if LUA_VERSION_NUM >= 503
+	if (lua_isinteger(L, idx))
+	{
+		lua_Integer i = lua_tointeger(L, idx);
+		if (i >= INT_MIN && i <= INT_MAX)
 		{
-			return luaL_error(L, "转换为定点数只支持0-6位小数精度");
+			*n = (int)i;
+			return 1;
 		}
-		val = val * _mul[len];
-		if (val >= 1000000000)
+	}
+#else
+	if (lua_type(L, idx) == LUA_TNUMBER)
+	{
+		lua_Number d = lua_tonumber(L, idx);
+		if (d >= INT_MIN && d <= INT_MAX && d == floor(d))
 		{
-			return luaL_error(L, "有效数字太多转不了，自己看着办");
+			*n = (int)d;
+			return 1;
 		}
-		round_val = (int)(val + (val > 0 ? 0.5 : -0.5));
-		if (fabs(val - round_val) > 0.2)
+	}
+#endif
+	return 0;
+}
+
+/*
+	把 idx 处的十进制字符串精确转成定点数, 不经过 double, 见 str2sll()
+	前后可以有空白, 整个字符串必须是一个数字, 否则直接 luaL_error
+*/
+sll fix_checkstring(lua_State *L, int idx)
+{
+	const char *s = luaL_checkstring(L, idx);
+	sll v;
+	int n = str2sll(s, &v);
+	if (n > 0)
+	{
+		while (s[n] == ' ' || (s[n] >= '\t' && s[n] <= '\r'))
 		{
-			return luaL_error(L, "第%d位小数怎么还有值？", len + 1);
+			n++;
 		}
-		// 这里可以直接除整数
-		push_fix(L, int2sll(round_val) / _mul[len]);
 	}
+	if (n == 0 || s[n] != '\0')
+	{
+		return luaL_error(L, "第%d个参数不是合法的定点数字符串: %s", idx, s);
+	}
+	return v;
+}
+
+/*
+	idx 处是输出的小数位数(0-32), 不传时是 6 位, 和以前的 "%.6f" 一样
+	传负数 -n 时最多 n 位并去掉末尾的 0
+*/
+int fix_optdigits(lua_State *L, int idx)
+{
+	if (lua_isnoneornil(L, idx))
+	{
+		return 6;
+	}
+	lua_Integer digits = luaL_checkinteger(L, idx);
+	if (digits < -32 || digits > 32)
+	{
+		return luaL_error(L, "小数位数只支持0-32位, 负数表示去掉末尾的 0");
+	}
+	return (int)digits;
+}
+
+/*
+	把 n 个定点数按 "(a,b,...)" 写进 buf, 每个 6 位小数, 返回长度
+	buf 至少要 n * 19 + 3 个字节
+*/
+int fix_format_tuple(char *buf, const sll *v, int n)
+{
+	int len = 0;
+	for (int i = 0; i < n; i++)
+	{
+		buf[len++] = i == 0 ? '(' : ',';
+		len += sll2str(v[i], 6, buf + len);
+	}
+	buf[len++] = ')';
+	buf[len] = '\0';
+	return len;
+}
+
+static int l_tofix(lua_State *L)
+{
+	lua_settop(L, 2);
+	test_set_fix(1, p);
+	if(p)
+	{
+		push_fix_up(L, *p);
+	}
+	else
+	{
+		push_fix_up(L, fix_checkdecimal(L, 1, 2));
+	}
+	return 1;
+}
+
+/*
+	fixmath.parse("123.4567"), 十进制字符串精确转成定点数
+*/
+static int fix_parse(lua_State *L)
+{
+	push_fix_up(L, fix_checkstring(L, 1));
 	return 1;
 }
 
@@ -55,7 +201,7 @@ static int l_tofix(lua_State *L)
 static int fix_int(lua_State *L)
 {
 	check_set_fix(1, p);
-	push_fix(L, sllint(*p));
+	push_fix_up(L, sllint(*p));
 	return 1;
 }
 
@@ -65,7 +211,7 @@ static int fix_int(lua_State *L)
 static int fix_frac(lua_State *L)
 {
 	check_set_fix(1, p);
-	push_fix(L, sllfrac(*p));
+	push_fix_up(L, sllfrac(*p));
 	return 1;
 }
 
@@ -79,83 +225,132 @@ static int fix_rawvalue(lua_State *L)
 	return 1;
 }
 
+/*
+	tostring(x [, digits]), 只用整数运算, 不经过 double
+	不传 digits 时固定 6 位小数, tostring(x, -6) 最多 6 位并去掉末尾的 0
+*/
 static int fix_tostring(lua_State *L)
 {
+	char buf[SLL_STR_MAX];
 	check_set_fix(1, p);
-	lua_pushnumber(L, (double)(*p) / (double)(CONST_1) );
+	lua_pushlstring(L, buf, sll2str(*p, fix_optdigits(L, 2), buf));
+	return 1;
+}
+
+static int fix_tonumber(lua_State *L)
+{
+	check_set_fix(1, p);
+	lua_pushnumber(L, sll2dbl(*p));
 	return 1;
 }
 
 static int fix_add(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	push_fix(L, slladd(*a, *b));
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	push_fix_up(L, slladd(a, b));
 	return 1;
 }
 
 static int fix_unm(lua_State *L)
 {
 	check_set_fix(1, p);
-	push_fix(L, sllneg(*p));
+	push_fix_up(L, sllneg(*p));
 	return 1;
 }
 
 static int fix_sub(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	push_fix(L, sllsub(*a, *b));
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	push_fix_up(L, sllsub(a, b));
 	return 1;
 }
 
+// 乘整数时用 sllmuli, 和 sllmul(a, int2sll(n)) 结果相同
 static int fix_mul(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	push_fix(L, sllmul(*a, *b));
+	int n;
+	if (fix_toint(L, 2, &n))
+	{
+		check_get_fix(1, a);
+		push_fix_up(L, sllmuli(a, n));
+		return 1;
+	}
+	if (fix_toint(L, 1, &n))
+	{
+		check_get_fix(2, b);
+		push_fix_up(L, sllmuli(b, n));
+		return 1;
+	}
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	push_fix_up(L, sllmul(a, b));
 	return 1;
 }
 
 static int fix_mul_2n(lua_State *L)
 {
 	check_set_fix(1, p);
-	push_fix(L, sllmul2n(*p, luaL_checkinteger(L, 2)));
+	push_fix_up(L, sllmul2n(*p, luaL_checkinteger(L, 2)));
 	return 1;
 }
 
+// 除以整数时用 slldivi, 得到截断到 0 的精确商
 static int fix_div(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	push_fix(L, slldiv(*a, *b));
+	int n;
+	check_get_fix(1, a);
+	if (fix_toint(L, 2, &n))
+	{
+		if (n == 0)
+		{
+			return luaL_error(L, "div zero!");
+		}
+		push_fix_up(L, slldivi(a, n));
+		return 1;
+	}
+	check_get_fix(2, b);
+	push_fix_up(L, slldiv(a, b));
 	return 1;
 }
 
 static int fix_div_2n(lua_State *L)
 {
 	check_set_fix(1, p);
-	push_fix(L, slldiv2n(*p, luaL_checkinteger(L, 2)));
+	push_fix_up(L, slldiv2n(*p, luaL_checkinteger(L, 2)));
 	return 1;
 }
 
 static int fix_mod(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	if (*b == 0)
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	if (b == 0)
 	{
 		return luaL_error(L, "mod zero!");
 	}
-	push_fix(L, *a % *b);
+	// CONST_MIN % -1 在 C 里会溢出 (x86 上直接 SIGFPE), 结果本来就是 0
+	push_fix_up(L, (b == -1) ? CONST_0 : a % b);
 	return 1;
 }
 
 static int fix_pow(lua_State *L)
+{
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	push_fix_up(L, sllpow(a, b));
+	return 1;
+}
+
+// 整数次幂, n 为 Lua 整数
+static int fix_powi(lua_State *L)
 {
 	check_set_fix(1, a);
-	check_set_fix(2, b);
-	push_fix(L, sllpow(*a, *b));
+	lua_Integer n = luaL_checkinteger(L, 2);
+	if (n > INT_MAX) n = INT_MAX;
+	if (n < -INT_MAX) n = -INT_MAX;
+	push_fix_up(L, sllpowi(*a, (int)n));
 	return 1;
 }
 
@@ -163,24 +358,24 @@ static int fix_pow(lua_State *L)
 static int fix_inv(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllinv(*a));
+	push_fix_up(L, sllinv(*a));
 	return 1;
 }
 
 // 比较函数
 static int fix_lt(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	lua_pushboolean(L, *a < *b);
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	lua_pushboolean(L, a < b);
 	return 1;
 }
 
 static int fix_le(lua_State *L)
 {
-	check_set_fix(1, a);
-	check_set_fix(2, b);
-	lua_pushboolean(L, *a <= *b);
+	check_get_fix(1, a);
+	check_get_fix(2, b);
+	lua_pushboolean(L, a <= b);
 	return 1;
 }
 static int fix_eq(lua_State *L)
@@ -195,20 +390,20 @@ static int fix_abs(lua_State *L)
 	check_set_fix(1, a);
 	sll x = *a;
 	x = sllabs(x);
-	push_fix(L, x);
+	push_fix_up(L, x);
 	return 1;
 }
 static int fix_floor(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllfloor(*a));
+	push_fix_up(L, sllfloor(*a));
 	return 1;
 }
 
 static int fix_ceil(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllceil(*a));
+	push_fix_up(L, sllceil(*a));
 	return 1;
 }
 static int fix_min(lua_State *L)
@@ -217,7 +412,7 @@ static int fix_min(lua_State *L)
 	check_set_fix(2, b);
 	sll x = *a;
 	sll y = *b;
-	push_fix(L, min(x, y));
+	push_fix_up(L, min(x, y));
 	return 1;	
 }
 static int fix_max(lua_State *L)
@@ -226,7 +421,7 @@ static int fix_max(lua_State *L)
 	check_set_fix(2, b);
 	sll x = *a;
 	sll y = *b;
-	push_fix(L, max(x, y));
+	push_fix_up(L, max(x, y));
 	return 1;
 }
 
@@ -234,132 +429,172 @@ static int fix_max(lua_State *L)
 static int fix_sin(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllsin(*a));
+	push_fix_up(L, sllsin(*a));
 	return 1;
 }
 static int fix_cos(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcos(*a));
+	push_fix_up(L, sllcos(*a));
 	return 1;
 }
+// 一次算出sin和cos，共用同一次象限归约
+static int fix_sincos(lua_State *L)
+{
+	check_set_fix(1, a);
+	sll s, c;
+	sllsincos(*a, &s, &c);
+	push_fix_up(L, s);
+	push_fix_up(L, c);
+	return 2;
+}
 static int fix_tan(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, slltan(*a));
+	push_fix_up(L, slltan(*a));
 	return 1;
 }
 static int fix_sec(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllsec(*a));
+	push_fix_up(L, sllsec(*a));
 	return 1;
 }
 static int fix_csc(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcsc(*a));
+	push_fix_up(L, sllcsc(*a));
 	return 1;
 }
 static int fix_cot(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcot(*a));
+	push_fix_up(L, sllcot(*a));
 	return 1;
 }
 static int fix_sinh(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllsinh(*a));
+	push_fix_up(L, sllsinh(*a));
 	return 1;
 }
 static int fix_cosh(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcosh(*a));
+	push_fix_up(L, sllcosh(*a));
 	return 1;
 }
 static int fix_tanh(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, slltanh(*a));
+	push_fix_up(L, slltanh(*a));
 	return 1;
 }
 static int fix_sech(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllsech(*a));
+	push_fix_up(L, sllsech(*a));
 	return 1;
 }
 static int fix_csch(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcsch(*a));
+	push_fix_up(L, sllcsch(*a));
 	return 1;
 }
 static int fix_coth(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllcoth(*a));
+	push_fix_up(L, sllcoth(*a));
 	return 1;
 }
 // 反三角函数
 static int fix_asin(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllasin(*a));
+	push_fix_up(L, sllasin(*a));
 	return 1;	
 }
 static int fix_acos(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllacos(*a));
+	push_fix_up(L, sllacos(*a));
 	return 1;
 }
 static int fix_atan(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllatan(*a));
+	push_fix_up(L, sllatan(*a));
+	return 1;
+}
+// atan(y / x)，按象限返回(-pi, pi]
+static int fix_atan2(lua_State *L)
+{
+	check_set_fix(1, y);
+	check_set_fix(2, x);
+	push_fix_up(L, sllatan2(*y, *x));
 	return 1;
 }
 static int fix_deg(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllmul(*a, CONST_180_PI));
+	push_fix_up(L, sllmul(*a, CONST_180_PI));
 	return 1;
 }
 static int fix_rad(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllmul(*a, CONST_PI_180));
+	push_fix_up(L, sllmul(*a, CONST_PI_180));
 	return 1;
 }
 
 static int fix_sqrt(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllsqrt(*a));
+	push_fix_up(L, sllsqrt(*a));
+	return 1;
+}
+
+// 1 / sqrt(a), a <= 0 返回 0
+static int fix_rsqrt(lua_State *L)
+{
+	check_set_fix(1, a);
+	push_fix_up(L, sllrsqrt(*a));
 	return 1;
 }
 
 static int fix_sqrt_ex(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, slld2dsqrt(*a));
+	push_fix_up(L, slld2dsqrt(*a));
 	return 1;
 }
 
 static int fix_exp(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, sllexp(*a));
+	push_fix_up(L, sllexp(*a));
 	return 1;	
 }
 
 static int fix_log(lua_State *L)
 {
 	check_set_fix(1, a);
-	push_fix(L, slllog(*a));
+	push_fix_up(L, slllog(*a));
+	return 1;
+}
+
+static int fix_exp2(lua_State *L)
+{
+	check_set_fix(1, a);
+	push_fix_up(L, sllexp2(*a));
+	return 1;
+}
+
+static int fix_log2(lua_State *L)
+{
+	check_set_fix(1, a);
+	push_fix_up(L, slllog2(*a));
 	return 1;
 }
 
@@ -381,7 +616,7 @@ static int fix_clamp(lua_State *L)
 	check_set_fix(1, a);
 	check_set_fix(2, b);
 	check_set_fix(3, c);
-	push_fix(L, clamp_fix(*a, *b, *c));
+	push_fix_up(L, clamp_fix(*a, *b, *c));
 	return 1;
 }
 // For internal use before precompile
@@ -410,7 +645,8 @@ const luaL_Reg lua_fixmath_meta_methods[] = {
 const luaL_Reg lua_fixmath_modules[] = {
 	{"tofix",   l_tofix},
 	{"tostring",   fix_tostring},
-	{"tonumber",   fix_tostring},
+	{"tonumber",   fix_tonumber},
+	{"parse",   fix_parse},
 	{"rawvalue",   fix_rawvalue},
 	{"int",   fix_int},
 	{"frac",   fix_frac},
@@ -426,6 +662,7 @@ const luaL_Reg lua_fixmath_modules[] = {
 // begin 三角函数
 	{"sin",   fix_sin},
 	{"cos",   fix_cos},
+	{"sincos",   fix_sincos},
 	{"tan",   fix_tan},
 	{"sec",   fix_sec},
 	{"csc",   fix_csc},
@@ -439,31 +676,82 @@ const luaL_Reg lua_fixmath_modules[] = {
 	{"asin",   fix_asin},
 	{"acos",   fix_acos},
 	{"atan",   fix_atan},
+	{"atan2",   fix_atan2},
 // end 三角函数
 
 	{"deg",   fix_deg},
 	{"rad",   fix_rad},
 	{"sqrt",   fix_sqrt},
 	{"sqrt_ex",   fix_sqrt_ex},	
+	{"rsqrt",   fix_rsqrt},
 	{"exp",   fix_exp},
 	{"log",   fix_log},
+	{"exp2",   fix_exp2},
+	{"log2",   fix_log2},
+	{"powi",   fix_powi},
 	//{"output_predefined_values", l_output_predefined_values}, // For internal use before precompile
 	{NULL, NULL}
 };
 
-static void fill_meta(lua_State *L)
+// 按 FIX_META_* 的顺序
+static const struct
+{
+	const char *name;
+	const luaL_Reg *meta_methods;
+	const luaL_Reg *modules;
+} fix_metas[FIX_META_COUNT] = {
+	{__METATABLE_NAME, lua_fixmath_meta_methods, lua_fixmath_modules},
+	{__VECTOR2_META__, lua_vec2_meta_methods, lua_vec2_modules},
+	{__VECTOR3_META__, lua_vec3_meta_methods, lua_vec3_modules},
+	{__FIX_ARRAY_META__, lua_fix_array_meta_methods, lua_fix_array_modules},
+	{__VECTOR3_ARRAY_META__, lua_vec3_array_meta_methods, lua_vec3_array_modules},
+	{__ROT2_META__, lua_rot2_meta_methods, lua_rot2_modules},
+	{__ROT4_META__, lua_rot4_meta_methods, lua_rot4_modules},
+	{__MATRIX3_META__, lua_mat3_meta_methods, lua_mat3_modules},
+	{__MATRIX4_META__, lua_mat4_meta_methods, lua_mat4_modules},
+};
+
+static void push_metatables_from(lua_State *L, int base)
 {
-	luaL_setfuncs(L, lua_fixmath_meta_methods, 0);
-	luaL_newlib(L, lua_fixmath_modules);
-  	lua_setfield(L, -2, "__index");
+	int i;
+	for (i = 0; i < FIX_META_COUNT; i++)
+	{
+		lua_pushvalue(L, base + i);
+	}
 }
 
-static void create_meta(lua_State *L)
+/*
+	压入全部 FIX_META_COUNT 个元表, 作为 luaL_setfuncs 的 upvalue
+	元表仍然按名字登记在注册表里, 只在第一次创建时填充
+	填充时元方法和 __index 里的函数同样带上全部元表作为 upvalue
+	所以任何一个 luaopen_* 都会引用全部模块的函数表, 链接时要带上全部 lua_fix*.c
+*/
+int fix_push_metatables(lua_State *L)
 {
-	if(luaL_newmetatable (L, __METATABLE_NAME) != 0)
+	int i;
+	int created[FIX_META_COUNT];
+	int base = lua_gettop(L) + 1;
+	luaL_checkstack(L, 2 * FIX_META_COUNT + 2, "too many upvalues");
+	for (i = 0; i < FIX_META_COUNT; i++)
 	{
-		fill_meta(L);
+		created[i] = luaL_newmetatable(L, fix_metas[i].name);
 	}
+	for (i = 0; i < FIX_META_COUNT; i++)
+	{
+		if (!created[i])
+		{
+			continue;
+		}
+		lua_pushvalue(L, base + i);
+		push_metatables_from(L, base);
+		luaL_setfuncs(L, fix_metas[i].meta_methods, FIX_META_COUNT);
+		lua_newtable(L);
+		push_metatables_from(L, base);
+		luaL_setfuncs(L, fix_metas[i].modules, FIX_META_COUNT);
+		lua_setfield(L, -2, "__index");
+		lua_pop(L, 1);
+	}
+	return FIX_META_COUNT;
 }
 
 #define push_const(x, y) push_fix(L, x); lua_setfield(L, -2, #y)
@@ -485,11 +773,18 @@ LUALIB_API int luaopen_fixmath(lua_State* L)
 	luaL_checkversion(L);
 #endif
 #if LUA_VERSION_NUM < 502
-    luaL_register(L, "fixmath", lua_fixmath_modules);
+    fix_push_metatables(L);
+    luaL_openlib(L, "fixmath", lua_fixmath_modules, FIX_META_COUNT);
 #else
     // 这个傻叉函数，在5.3以前实际是new了一个新的table，然后setfunc，其实没注册到loaded
-    luaL_newlib(L, lua_fixmath_modules);
+    luaL_newlibtable(L, lua_fixmath_modules);
+    fix_push_metatables(L);
+    luaL_setfuncs(L, lua_fixmath_modules, FIX_META_COUNT);
 #endif
     fill_const(L);
+#if LUA_VERSION_NUM >= 503
+    luaopen_fixmath_raw(L);
+    lua_setfield(L, -2, "raw");
+#endif
 	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "math-sll.h"
+#include <limits.h>
+
+/*
+	fixmath.raw: 定点数直接用 lua_Integer 表示, 不分配 userdata
+	sll 和 5.3 以后的 lua_Integer 一样是 64 位, 原始值可以原样放进去
+	加减和比较直接用 Lua 的整数运算, 其余运算用这里的函数
+	需要和 fixmath 互通时用 box / unbox
+*/
+#if LUA_VERSION_NUM >= 503
+
+#define check_raw(idx) ((sll)luaL_checkinteger(L, idx))
+
+#define RAW_FUNC1(name, expr) \
+static int raw_##name(lua_State *L) \
+{ \
+	sll a = check_raw(1); \
+	lua_pushinteger(L, (lua_Integer)(expr)); \
+	return 1; \
+}
+
+#define RAW_FUNC2(name, expr) \
+static int raw_##name(lua_State *L) \
+{ \
+	sll a = check_raw(1); \
+	sll b = check_raw(2); \
+	lua_pushinteger(L, (lua_Integer)(expr)); \
+	return 1; \
+}
+
+// 第二个参数是 Lua 整数而不是定点数
+#define RAW_FUNC_N(name, expr) \
+static int raw_##name(lua_State *L) \
+{ \
+	sll a = check_raw(1); \
+	lua_Integer n = luaL_checkinteger(L, 2); \
+	lua_pushinteger(L, (lua_Integer)(expr)); \
+	return 1; \
+}
+
+RAW_FUNC2(add, slladd(a, b))
+RAW_FUNC2(sub, sllsub(a, b))
+RAW_FUNC2(mul, sllmul(a, b))
+RAW_FUNC2(div, slldiv(a, b))
+RAW_FUNC2(pow, sllpow(a, b))
+RAW_FUNC2(min, min(a, b))
+RAW_FUNC2(max, max(a, b))
+RAW_FUNC2(atan2, sllatan2(a, b))
+
+RAW_FUNC1(unm, sllneg(a))
+RAW_FUNC1(int, sllint(a))
+RAW_FUNC1(frac, sllfrac(a))
+RAW_FUNC1(abs, sllabs(a))
+RAW_FUNC1(floor, sllfloor(a))
+RAW_FUNC1(ceil, sllceil(a))
+RAW_FUNC1(inv, sllinv(a))
+
+RAW_FUNC1(sin, sllsin(a))
+RAW_FUNC1(cos, sllcos(a))
+RAW_FUNC1(tan, slltan(a))
+RAW_FUNC1(sec, sllsec(a))
+RAW_FUNC1(csc, sllcsc(a))
+RAW_FUNC1(cot, sllcot(a))
+RAW_FUNC1(sinh, sllsinh(a))
+RAW_FUNC1(cosh, sllcosh(a))
+RAW_FUNC1(tanh, slltanh(a))
+RAW_FUNC1(sech, sllsech(a))
+RAW_FUNC1(csch, sllcsch(a))
+RAW_FUNC1(coth, sllcoth(a))
+RAW_FUNC1(asin, sllasin(a))
+RAW_FUNC1(acos, sllacos(a))
+RAW_FUNC1(atan, sllatan(a))
+RAW_FUNC1(deg, sllmul(a, CONST_180_PI))
+RAW_FUNC1(rad, sllmul(a, CONST_PI_180))
+
+RAW_FUNC1(sqrt, sllsqrt(a))
+RAW_FUNC1(rsqrt, sllrsqrt(a))
+RAW_FUNC1(sqrt_ex, slld2dsqrt(a))
+RAW_FUNC1(exp, sllexp(a))
+RAW_FUNC1(log, slllog(a))
+RAW_FUNC1(exp2, sllexp2(a))
+RAW_FUNC1(log2, slllog2(a))
+
+RAW_FUNC_N(mul_2n, sllmul2n(a, (int)n))
+RAW_FUNC_N(div_2n, slldiv2n(a, (int)n))
+RAW_FUNC_N(powi, sllpowi(a, (int)(n > INT_MAX ? INT_MAX : (n < -INT_MAX ? -INT_MAX : n))))
+
+static int raw_mod(lua_State *L)
+{
+	sll a = check_raw(1);
+	sll b = check_raw(2);
+	if (b == 0)
+	{
+		return luaL_error(L, "mod zero!");
+	}
+	// math.mininteger % -1 在 C 里会溢出 (x86 上直接 SIGFPE), 结果本来就是 0
+	lua_pushinteger(L, (b == -1) ? 0 : a % b);
+	return 1;
+}
+
+static int raw_clamp(lua_State *L)
+{
+	sll a = check_raw(1);
+	sll b = check_raw(2);
+	sll c = check_raw(3);
+	lua_pushinteger(L, clamp_fix(a, b, c));
+	return 1;
+}
+
+// 一次算出sin和cos，共用同一次象限归约
+static int raw_sincos(lua_State *L)
+{
+	sll s, c;
+	sllsincos(check_raw(1), &s, &c);
+	lua_pushinteger(L, s);
+	lua_pushinteger(L, c);
+	return 2;
+}
+
+// 和 fixmath.tofix 同样的规则, 定点数 userdata 直接拆箱
+static int raw_tofix(lua_State *L)
+{
+	lua_settop(L, 2);
+	test_set_fix(1, p);
+	lua_pushinteger(L, p ? *p : fix_checkdecimal(L, 1, 2));
+	return 1;
+}
+
+static int raw_tonumber(lua_State *L)
+{
+	lua_pushnumber(L, sll2dbl(check_raw(1)));
+	return 1;
+}
+
+// 十进制字符串精确转成原始整数, 规则同 fixmath.parse
+static int raw_parse(lua_State *L)
+{
+	lua_pushinteger(L, fix_checkstring(L, 1));
+	return 1;
+}
+
+// tostring(x [, digits]), 规则同 fixmath.tostring
+static int raw_tostring(lua_State *L)
+{
+	char buf[SLL_STR_MAX];
+	sll a = check_raw(1);
+	lua_pushlstring(L, buf, sll2str(a, fix_optdigits(L, 2), buf));
+	return 1;
+}
+
+// 原始整数 -> fixmath 定点数
+static int raw_box(lua_State *L)
+{
+	push_fix_up(L, check_raw(1));
+	return 1;
+}
+
+// fixmath 定点数 -> 原始整数
+static int raw_unbox(lua_State *L)
+{
+	check_set_fix(1, p);
+	lua_pushinteger(L, *p);
+	return 1;
+}
+
+static const luaL_Reg lua_fixmath_raw_modules[] = {
+	{"tofix",   raw_tofix},
+	{"tonumber",   raw_tonumber},
+	{"parse",   raw_parse},
+	{"tostring",   raw_tostring},
+	{"box",   raw_box},
+	{"unbox",   raw_unbox},
+	{"add",   raw_add},
+	{"sub",   raw_sub},
+	{"mul",   raw_mul},
+	{"div",   raw_div},
+	{"mod",   raw_mod},
+	{"unm",   raw_unm},
+	{"pow",   raw_pow},
+	{"powi",   raw_powi},
+	{"int",   raw_int},
+	{"frac",   raw_frac},
+	{"abs",   raw_abs},
+	{"floor",   raw_floor},
+	{"ceil",   raw_ceil},
+	{"mul_2n",   raw_mul_2n},
+	{"div_2n",   raw_div_2n},
+	{"inv",   raw_inv},
+	{"min",   raw_min},
+	{"max",   raw_max},
+	{"clamp",	raw_clamp},
+// begin 三角函数
+	{"sin",   raw_sin},
+	{"cos",   raw_cos},
+	{"sincos",   raw_sincos},
+	{"tan",   raw_tan},
+	{"sec",   raw_sec},
+	{"csc",   raw_csc},
+	{"cot",   raw_cot},
+	{"sinh",   raw_sinh},
+	{"cosh",   raw_cosh},
+	{"tanh",   raw_tanh},
+	{"sech",   raw_sech},
+	{"csch",   raw_csch},
+	{"coth",   raw_coth},
+	{"asin",   raw_asin},
+	{"acos",   raw_acos},
+	{"atan",   raw_atan},
+	{"atan2",   raw_atan2},
+// end 三角函数
+
+	{"deg",   raw_deg},
+	{"rad",   raw_rad},
+	{"sqrt",   raw_sqrt},
+	{"sqrt_ex",   raw_sqrt_ex},
+	{"rsqrt",   raw_rsqrt},
+	{"exp",   raw_exp},
+	{"log",   raw_log},
+	{"exp2",   raw_exp2},
+	{"log2",   raw_log2},
+	{NULL, NULL}
+};
+
+#define push_raw_const(x, y) lua_pushinteger(L, (lua_Integer)(x)); lua_setfield(L, -2, #y)
+static void fill_raw_const(lua_State *L)
+{
+	push_raw_const(CONST_0, zero);
+	push_raw_const(CONST_1, one);
+	push_raw_const(CONST_2, two);
+	push_raw_const(CONST_E, e);
+	push_raw_const(CONST_1_2, half);
+	push_raw_const(CONST_PI, pi);
+	push_raw_const(CONST_MAX, huge);
+	push_raw_const(CONST_MIN, tiny);
+}
+
+LUALIB_API int luaopen_fixmath_raw(lua_State* L)
+{
+#ifdef luaL_checkversion
+	luaL_checkversion(L);
+#endif
+	luaL_newlibtable(L, lua_fixmath_raw_modules);
+	fix_push_metatables(L);
+	luaL_setfuncs(L, lua_fixmath_raw_modules, FIX_META_COUNT);
+	fill_raw_const(L);
+	return 1;
+}
+
+#endif /* LUA_VERSION_NUM >= 503 */
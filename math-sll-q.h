@@ -0,0 +1,263 @@
+#if !defined(MATH_SLL_Q_H)
+#  define MATH_SLL_Q_H
+
+#include "math-sll.h"
+
+/*
+ * Q16.16 and Q48.16 formats
+ *
+ * Description
+ *
+ *	q16 is Q16.16 in 32 bits: half the memory of sll, and twice the lanes
+ *	per SIMD register, for large buffers of positions where 1 / 65536 is
+ *	fine enough and +-32768 is far enough.
+ *
+ *	q48 is Q48.16 in 64 bits, for accumulators that outgrow the +-2^31
+ *	integer range of sll.
+ *
+ *	Both follow the sll conventions.  Addition, subtraction and comparison
+ *	are the integer operators.  Products are chopped, or rounded to nearest
+ *	under SLL_MUL_ROUND.  Quotients are exact, truncated toward zero, and
+ *	saturate on overflow and on division by zero, like slldiv_exact().
+ *	Square roots are rounded to nearest, and negative arguments give 0.
+ *
+ *	q48 multiply, divide and square root are the sllq*() kernels with 16
+ *	fractional bits.  q16 needs no more than 64 bit arithmetic.
+ *
+ *	Trigonometry goes through the sll kernels.  q16 -> sll is exact and the
+ *	result is rounded back; a q48 argument must be within the sll range.
+ *
+ *	Conversions that drop fractional bits round to nearest, ties up, and
+ *	conversions into a narrower range saturate.
+ *
+ * Functions
+ *
+ *	q16 int2q16(int i)			i, saturating
+ *	int q162int(q16 x)			floor x
+ *	q16 dbl2q16(double d)			d, saturating
+ *	double q162dbl(q16 x)			x
+ *	q16 sll2q16(sll x)			x, rounded, saturating
+ *	sll q162sll(q16 x)			x, exact
+ *	q48 sll2q48(sll x)			x, rounded
+ *	sll q482sll(q48 x)			x, saturating
+ *	q48 q162q48(q16 x)			x, exact
+ *	q16 q482q16(q48 x)			x, saturating
+ *
+ *	q16 q16mul(q16 x, q16 y)		x * y
+ *	q16 q16div(q16 x, q16 y)		x / y
+ *	q16 q16sqrt(q16 x)			x^(1 / 2)
+ *	q16 q16sin(q16 x)			sin x
+ *	q16 q16cos(q16 x)			cos x
+ *	q16 q16atan2(q16 y, q16 x)		atan (y / x), by quadrant
+ *
+ *	q48 int2q48(sll i)			i, |i| < 2^47
+ *	sll q482int(q48 x)			floor x
+ *	q48 q48mul(q48 x, q48 y)		x * y
+ *	q48 q48div(q48 x, q48 y)		x / y
+ *	q48 q48sqrt(q48 x)			x^(1 / 2)
+ *	q48 q48sin(q48 x)			sin x
+ *	q48 q48cos(q48 x)			cos x
+ *	q48 q48atan2(q48 y, q48 x)		atan (y / x), by quadrant
+ *
+ *	void sll2q16_array(const sll *src, q16 *dst, int n)
+ *	void q162sll_array(const q16 *src, sll *dst, int n)
+ */
+
+typedef int32_t q16;
+typedef int64_t q48;
+
+#define Q16_FRAC	16
+#define Q16_1		((q16) 0x00010000)
+#define Q16_MAX		((q16) 0x7fffffff)
+#define Q16_MIN		((q16) (-0x7fffffff - 1))
+
+#define Q48_FRAC	16
+#define Q48_1		((q48) 0x0000000000010000LL)
+
+/* sll has 32 fractional bits, both Q formats 16 */
+#define _SLLQ_SHIFT	(32 - Q16_FRAC)
+
+static __inline__ q16 _q16sat(sll x)
+{
+	if (x > Q16_MAX)
+		return Q16_MAX;
+	if (x < Q16_MIN)
+		return Q16_MIN;
+	return (q16) x;
+}
+
+/*
+ * Conversions
+ */
+
+static __inline__ q16 int2q16(int i)
+{
+	return _q16sat((sll) i * Q16_1);
+}
+
+static __inline__ int q162int(q16 x)
+{
+	return x >> Q16_FRAC;
+}
+
+static __inline__ q16 sll2q16(sll x)
+{
+	return _q16sat(sllqconv(x, 32, Q16_FRAC));
+}
+
+static __inline__ sll q162sll(q16 x)
+{
+	return (sll) x * ((sll) 1 << _SLLQ_SHIFT);
+}
+
+static __inline__ q16 dbl2q16(double d)
+{
+	return sll2q16(dbl2sll(d));
+}
+
+static __inline__ double q162dbl(q16 x)
+{
+	return (double) x * (1.0 / 65536.0);
+}
+
+static __inline__ q48 sll2q48(sll x)
+{
+	return sllqconv(x, 32, Q48_FRAC);
+}
+
+static __inline__ sll q482sll(q48 x)
+{
+	return sllqconv(x, Q48_FRAC, 32);
+}
+
+static __inline__ q48 q162q48(q16 x)
+{
+	return (q48) x;
+}
+
+static __inline__ q16 q482q16(q48 x)
+{
+	return _q16sat(x);
+}
+
+static __inline__ q48 int2q48(sll i)
+{
+	return i * Q48_1;
+}
+
+static __inline__ sll q482int(q48 x)
+{
+	return x >> Q48_FRAC;
+}
+
+/*
+ * Q16.16 arithmetic
+ *
+ * Description
+ *
+ *	The 32 x 32 bit product and the dividend x * 2^16 both fit in 64 bits,
+ *	so nothing here needs the 128 bit kernels.
+ */
+
+static __inline__ q16 q16mul(q16 x, q16 y)
+{
+	sll p = (sll) x * y;
+
+#if defined(SLL_MUL_ROUND)
+	p += (sll) 1 << (Q16_FRAC - 1);
+#endif /* defined(SLL_MUL_ROUND) */
+
+	return (q16) (uint32_t) (ull) (p >> Q16_FRAC);
+}
+
+static __inline__ q16 q16div(q16 x, q16 y)
+{
+	if (y == 0)
+		return (x == 0) ? 0 : ((x < 0) ? Q16_MIN : Q16_MAX);
+	return _q16sat((sll) x * Q16_1 / y);
+}
+
+static __inline__ q16 q16sqrt(q16 x)
+{
+	return (q16) sllqsqrt(x, Q16_FRAC);
+}
+
+static __inline__ q16 q16sin(q16 x)
+{
+	return sll2q16(sllsin(q162sll(x)));
+}
+
+static __inline__ q16 q16cos(q16 x)
+{
+	return sll2q16(sllcos(q162sll(x)));
+}
+
+static __inline__ q16 q16atan2(q16 y, q16 x)
+{
+	return sll2q16(sllatan2(q162sll(y), q162sll(x)));
+}
+
+/*
+ * Q48.16 arithmetic
+ */
+
+static __inline__ q48 q48mul(q48 x, q48 y)
+{
+	return sllqmul(x, y, Q48_FRAC);
+}
+
+static __inline__ q48 q48div(q48 x, q48 y)
+{
+	return sllqdiv(x, y, Q48_FRAC);
+}
+
+static __inline__ q48 q48sqrt(q48 x)
+{
+	return sllqsqrt(x, Q48_FRAC);
+}
+
+static __inline__ q48 q48sin(q48 x)
+{
+	return sll2q48(sllsin(q482sll(x)));
+}
+
+static __inline__ q48 q48cos(q48 x)
+{
+	return sll2q48(sllcos(q482sll(x)));
+}
+
+/* Only the ratio matters, so both are scaled into the sll range together */
+static __inline__ q48 q48atan2(q48 y, q48 x)
+{
+	ull ay = (y < 0) ? 0 - (ull) y : (ull) y;
+	ull ax = (x < 0) ? 0 - (ull) x : (ull) x;
+	int n = sllbitlen(ay > ax ? ay : ax) - 47;
+
+	if (n > 0) {
+		y >>= n;
+		x >>= n;
+	}
+	return sll2q48(sllatan2(q482sll(y), q482sll(x)));
+}
+
+/*
+ * Buffer conversions, for packing sll positions into q16 storage and back
+ */
+
+static __inline__ void sll2q16_array(const sll *src, q16 *dst, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = sll2q16(src[i]);
+}
+
+static __inline__ void q162sll_array(const q16 *src, sll *dst, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		dst[i] = q162sll(src[i]);
+}
+
+#endif /* !defined(MATH_SLL_Q_H) */
@@ -0,0 +1,273 @@
+/*
+ * Generated by tools/gen-sll-sintab.c - do not edit
+ *
+ * sin (k * pi / 512) for 0 <= k <= 256
+ */
+
+#if !defined(MATH_SLL_SINTAB_H)
+#  define MATH_SLL_SINTAB_H
+
+#define SLL_SINTAB_SIZE	256
+#define SLL_SINTAB_STEP	0x01921fb54442d184ULL	// pi / 512, 0.64 format
+
+static const sll sll_sintab[SLL_SINTAB_SIZE + 1] = {
+	0x0000000000000000LL,	//   0
+	0x0000000001921f10LL,	//   1
+	0x0000000003243a40LL,	//   2
+	0x0000000004b64dafLL,	//   3
+	0x000000000648557eLL,	//   4
+	0x0000000007da4dccLL,	//   5
+	0x00000000096c32bbLL,	//   6
+	0x000000000afe0069LL,	//   7
+	0x000000000c8fb2f9LL,	//   8
+	0x000000000e214689LL,	//   9
+	0x000000000fb2b73dLL,	//  10
+	0x0000000011440135LL,	//  11
+	0x0000000012d52093LL,	//  12
+	0x0000000014661179LL,	//  13
+	0x0000000015f6d00bLL,	//  14
+	0x000000001787586aLL,	//  15
+	0x000000001917a6bcLL,	//  16
+	0x000000001aa7b724LL,	//  17
+	0x000000001c3785c8LL,	//  18
+	0x000000001dc70eccLL,	//  19
+	0x000000001f564e57LL,	//  20
+	0x0000000020e5408fLL,	//  21
+	0x000000002273e19eLL,	//  22
+	0x0000000024022daaLL,	//  23
+	0x00000000259020ddLL,	//  24
+	0x00000000271db762LL,	//  25
+	0x0000000028aaed62LL,	//  26
+	0x000000002a37bf0bLL,	//  27
+	0x000000002bc42889LL,	//  28
+	0x000000002d50260aLL,	//  29
+	0x000000002edbb3bdLL,	//  30
+	0x000000003066cdd1LL,	//  31
+	0x0000000031f17079LL,	//  32
+	0x00000000337b97e6LL,	//  33
+	0x000000003505404bLL,	//  34
+	0x00000000368e65deLL,	//  35
+	0x00000000381704d5LL,	//  36
+	0x00000000399f1966LL,	//  37
+	0x000000003b269fcbLL,	//  38
+	0x000000003cad943cLL,	//  39
+	0x000000003e33f2f6LL,	//  40
+	0x000000003fb9b836LL,	//  41
+	0x00000000413ee039LL,	//  42
+	0x0000000042c3673fLL,	//  43
+	0x000000004447498bLL,	//  44
+	0x0000000045ca835eLL,	//  45
+	0x00000000474d10fdLL,	//  46
+	0x0000000048ceeeafLL,	//  47
+	0x000000004a5018bbLL,	//  48
+	0x000000004bd08b6cLL,	//  49
+	0x000000004d50430cLL,	//  50
+	0x000000004ecf3be8LL,	//  51
+	0x00000000504d7250LL,	//  52
+	0x0000000051cae295LL,	//  53
+	0x000000005347890aLL,	//  54
+	0x0000000054c36203LL,	//  55
+	0x00000000563e69d7LL,	//  56
+	0x0000000057b89cdeLL,	//  57
+	0x000000005931f775LL,	//  58
+	0x000000005aaa75f7LL,	//  59
+	0x000000005c2214c4LL,	//  60
+	0x000000005d98d03dLL,	//  61
+	0x000000005f0ea4c4LL,	//  62
+	0x0000000060838ec1LL,	//  63
+	0x0000000061f78a9bLL,	//  64
+	0x00000000636a94bbLL,	//  65
+	0x0000000064dca98fLL,	//  66
+	0x00000000664dc585LL,	//  67
+	0x0000000067bde50fLL,	//  68
+	0x00000000692d049fLL,	//  69
+	0x000000006a9b20aeLL,	//  70
+	0x000000006c0835b2LL,	//  71
+	0x000000006d744028LL,	//  72
+	0x000000006edf3c8cLL,	//  73
+	0x0000000070492760LL,	//  74
+	0x0000000071b1fd26LL,	//  75
+	0x000000007319ba65LL,	//  76
+	0x0000000074805ba4LL,	//  77
+	0x0000000075e5dd6eLL,	//  78
+	0x00000000774a3c52LL,	//  79
+	0x0000000078ad74e0LL,	//  80
+	0x000000007a0f83acLL,	//  81
+	0x000000007b70654cLL,	//  82
+	0x000000007cd01659LL,	//  83
+	0x000000007e2e9370LL,	//  84
+	0x000000007f8bd930LL,	//  85
+	0x0000000080e7e43aLL,	//  86
+	0x000000008242b135LL,	//  87
+	0x00000000839c3cc9LL,	//  88
+	0x0000000084f483a1LL,	//  89
+	0x00000000864b826bLL,	//  90
+	0x0000000087a135d9LL,	//  91
+	0x0000000088f59aa1LL,	//  92
+	0x000000008a48ad7aLL,	//  93
+	0x000000008b9a6b1fLL,	//  94
+	0x000000008cead050LL,	//  95
+	0x000000008e39d9cdLL,	//  96
+	0x000000008f87845eLL,	//  97
+	0x0000000090d3cccaLL,	//  98
+	0x00000000921eafddLL,	//  99
+	0x0000000093682a67LL,	// 100
+	0x0000000094b0393bLL,	// 101
+	0x0000000095f6d930LL,	// 102
+	0x00000000973c071fLL,	// 103
+	0x00000000987fbfe7LL,	// 104
+	0x0000000099c20068LL,	// 105
+	0x000000009b02c588LL,	// 106
+	0x000000009c420c2fLL,	// 107
+	0x000000009d7fd149LL,	// 108
+	0x000000009ebc11c6LL,	// 109
+	0x000000009ff6ca9aLL,	// 110
+	0x00000000a12ff8bcLL,	// 111
+	0x00000000a2679928LL,	// 112
+	0x00000000a39da8ddLL,	// 113
+	0x00000000a4d224ddLL,	// 114
+	0x00000000a6050a2fLL,	// 115
+	0x00000000a73655dfLL,	// 116
+	0x00000000a86604fbLL,	// 117
+	0x00000000a9941495LL,	// 118
+	0x00000000aac081c5LL,	// 119
+	0x00000000abeb49a4LL,	// 120
+	0x00000000ad146953LL,	// 121
+	0x00000000ae3bddf3LL,	// 122
+	0x00000000af61a4acLL,	// 123
+	0x00000000b085baa9LL,	// 124
+	0x00000000b1a81d19LL,	// 125
+	0x00000000b2c8c930LL,	// 126
+	0x00000000b3e7bc25LL,	// 127
+	0x00000000b504f334LL,	// 128
+	0x00000000b6206b9eLL,	// 129
+	0x00000000b73a22a7LL,	// 130
+	0x00000000b8521599LL,	// 131
+	0x00000000b96841bfLL,	// 132
+	0x00000000ba7ca46dLL,	// 133
+	0x00000000bb8f3af8LL,	// 134
+	0x00000000bca002baLL,	// 135
+	0x00000000bdaef913LL,	// 136
+	0x00000000bebc1b66LL,	// 137
+	0x00000000bfc7671bLL,	// 138
+	0x00000000c0d0d99eLL,	// 139
+	0x00000000c1d87060LL,	// 140
+	0x00000000c2de28d7LL,	// 141
+	0x00000000c3e2007eLL,	// 142
+	0x00000000c4e3f4d2LL,	// 143
+	0x00000000c5e40359LL,	// 144
+	0x00000000c6e22999LL,	// 145
+	0x00000000c7de651fLL,	// 146
+	0x00000000c8d8b37fLL,	// 147
+	0x00000000c9d1124dLL,	// 148
+	0x00000000cac77f24LL,	// 149
+	0x00000000cbbbf7a6LL,	// 150
+	0x00000000ccae7977LL,	// 151
+	0x00000000cd9f0240LL,	// 152
+	0x00000000ce8d8fafLL,	// 153
+	0x00000000cf7a1f79LL,	// 154
+	0x00000000d064af56LL,	// 155
+	0x00000000d14d3d02LL,	// 156
+	0x00000000d233c641LL,	// 157
+	0x00000000d31848d8LL,	// 158
+	0x00000000d3fac295LL,	// 159
+	0x00000000d4db3148LL,	// 160
+	0x00000000d5b992c9LL,	// 161
+	0x00000000d695e4f1LL,	// 162
+	0x00000000d77025a2LL,	// 163
+	0x00000000d84852c1LL,	// 164
+	0x00000000d91e6a38LL,	// 165
+	0x00000000d9f269f8LL,	// 166
+	0x00000000dac44ff5LL,	// 167
+	0x00000000db941a29LL,	// 168
+	0x00000000dc61c694LL,	// 169
+	0x00000000dd2d533aLL,	// 170
+	0x00000000ddf6be25LL,	// 171
+	0x00000000debe0563LL,	// 172
+	0x00000000df83270bLL,	// 173
+	0x00000000e0462134LL,	// 174
+	0x00000000e106f1fdLL,	// 175
+	0x00000000e1c5978cLL,	// 176
+	0x00000000e2821009LL,	// 177
+	0x00000000e33c59a4LL,	// 178
+	0x00000000e3f47291LL,	// 179
+	0x00000000e4aa590aLL,	// 180
+	0x00000000e55e0b4dLL,	// 181
+	0x00000000e60f87a0LL,	// 182
+	0x00000000e6becc4cLL,	// 183
+	0x00000000e76bd7a2LL,	// 184
+	0x00000000e816a7f6LL,	// 185
+	0x00000000e8bf3ba2LL,	// 186
+	0x00000000e9659107LL,	// 187
+	0x00000000ea09a68aLL,	// 188
+	0x00000000eaab7a97LL,	// 189
+	0x00000000eb4b0b9eLL,	// 190
+	0x00000000ebe85816LL,	// 191
+	0x00000000ec835e7aLL,	// 192
+	0x00000000ed1c1d4bLL,	// 193
+	0x00000000edb29312LL,	// 194
+	0x00000000ee46be5aLL,	// 195
+	0x00000000eed89db6LL,	// 196
+	0x00000000ef682fbfLL,	// 197
+	0x00000000eff57311LL,	// 198
+	0x00000000f0806651LL,	// 199
+	0x00000000f1090828LL,	// 200
+	0x00000000f18f5744LL,	// 201
+	0x00000000f2135259LL,	// 202
+	0x00000000f294f824LL,	// 203
+	0x00000000f3144762LL,	// 204
+	0x00000000f3913edbLL,	// 205
+	0x00000000f40bdd5aLL,	// 206
+	0x00000000f48421b1LL,	// 207
+	0x00000000f4fa0ab6LL,	// 208
+	0x00000000f56d9747LL,	// 209
+	0x00000000f5dec647LL,	// 210
+	0x00000000f64d969eLL,	// 211
+	0x00000000f6ba073bLL,	// 212
+	0x00000000f7241713LL,	// 213
+	0x00000000f78bc51fLL,	// 214
+	0x00000000f7f11060LL,	// 215
+	0x00000000f853f7ddLL,	// 216
+	0x00000000f8b47aa0LL,	// 217
+	0x00000000f91297bcLL,	// 218
+	0x00000000f96e4e48LL,	// 219
+	0x00000000f9c79d63LL,	// 220
+	0x00000000fa1e8430LL,	// 221
+	0x00000000fa7301d8LL,	// 222
+	0x00000000fac5158cLL,	// 223
+	0x00000000fb14be80LL,	// 224
+	0x00000000fb61fbf0LL,	// 225
+	0x00000000fbaccd1dLL,	// 226
+	0x00000000fbf5314fLL,	// 227
+	0x00000000fc3b27d4LL,	// 228
+	0x00000000fc7eaffdLL,	// 229
+	0x00000000fcbfc926LL,	// 230
+	0x00000000fcfe72adLL,	// 231
+	0x00000000fd3aabf8LL,	// 232
+	0x00000000fd747472LL,	// 233
+	0x00000000fdabcb8dLL,	// 234
+	0x00000000fde0b0bfLL,	// 235
+	0x00000000fe132387LL,	// 236
+	0x00000000fe432368LL,	// 237
+	0x00000000fe70afebLL,	// 238
+	0x00000000fe9bc8a1LL,	// 239
+	0x00000000fec46d1fLL,	// 240
+	0x00000000feea9d00LL,	// 241
+	0x00000000ff0e57e6LL,	// 242
+	0x00000000ff2f9d79LL,	// 243
+	0x00000000ff4e6d68LL,	// 244
+	0x00000000ff6ac766LL,	// 245
+	0x00000000ff84ab2cLL,	// 246
+	0x00000000ff9c187cLL,	// 247
+	0x00000000ffb10f1cLL,	// 248
+	0x00000000ffc38ed7LL,	// 249
+	0x00000000ffd39780LL,	// 250
+	0x00000000ffe128f0LL,	// 251
+	0x00000000ffec4304LL,	// 252
+	0x00000000fff4e5a2LL,	// 253
+	0x00000000fffb10b5LL,	// 254
+	0x00000000fffec42cLL,	// 255
+	0x0000000100000000LL,	// 256
+};
+
+#endif /* !defined(MATH_SLL_SINTAB_H) */
@@ -43,148 +43,332 @@
 /* See header for full details */
 #include "math-sll.h"
 
+#if defined(SLL_TRIG_TABLE)
+#include "math-sll-sintab.h"
+#endif /* defined(SLL_TRIG_TABLE) */
+
+#if !defined(SLL_NO_SIMD)
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) \
+	|| __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))
+#  define SLL_SIMD_AVX2
+#  include <immintrin.h>
+#elif defined(__aarch64__)
+#  define SLL_SIMD_NEON
+#  include <arm_neon.h>
+#endif
+#endif /* !defined(SLL_NO_SIMD) */
+
 /*
  * Local prototypes
  */
 
 static sll _sllcos(sll x);
 static sll _sllsin(sll x);
+static void _sllsincos(sll x, sll *s, sll *c);
 
-static sll _sllexp(sll x);
+static sll _sllexp2(sll x);
+static sll _slllog(sll x, int *k, int *j);
 
 /*
- * Unpack IEEE 754 floating point double format into fixed point sll format
+ * Convert a double into fixed point sll format
  *
  * Description
  *
- *	IEEE 754 specifies the binary64 type ("double" in C) as having:
- *
- *	1 bit sign
- *	11 bit exponent
- *	53 bit significand
+ *	sll = d * 2^32, truncated toward zero
  *
- *	The first bit of the significand is an implied 1 which is not stored.
- *	The decimal would be to the right of that implied 1, or to the left of
- *	the stored significand.
+ *	Scaling by 2^32 only changes the exponent, so it is exact, and the
+ *	conversion to a 64 bit integer is a single instruction on anything with
+ *	an FPU.  No loops and no endian-dependent unpacking.
  *
- *	The exponent is unsigned, and biased with an offset of 1023.
- *
- *	The IEEE 754 standard does not specify endianess, but the endian used is
- *	traditionally the same endian that the processor uses.
+ *	Out of range values saturate:
+ *	d >= 2^31 returns CONST_MAX
+ *	d <= -2^31 returns CONST_MIN
+ *	NaN returns 0
  */
 
 sll dbl2sll(double dbl)
 {
-	union {
-		double d;
-		unsigned u[2];
-		ull ull;
-		sll sll;
-	} in, retval;
-	register unsigned exp;
-
-	/* Move into memory as args might be passed in regs */
-	in.d = dbl;
+	/* NaN fails every comparison */
+	if (!(dbl == dbl))
+		return CONST_0;
+	if (dbl >= 2147483648.0)
+		return CONST_MAX;
+	if (dbl <= -2147483648.0)
+		return CONST_MIN;
+
+	return (sll) (dbl * 4294967296.0);
+}
 
-#if defined(BROKEN_IEEE754_DOUBLE)
+/*
+ * Convert fixed point sll format into a double
+ *
+ * Description
+ *
+ *	d = sll * 2^-32
+ *
+ *	The integer conversion rounds to the 53 bit significand of a double
+ *	(exact for |sll| < 2^53, i.e. |d| < 2^21), and the scaling is exact.
+ */
 
-	exp = in.u[0];
-	in.u[0] = in.u[1];
-	in.u[1] = exp;
+double sll2dbl(sll s)
+{
+	return (double) s * (1.0 / 4294967296.0);
+}
 
-#endif /* defined(BROKEN_IEEE754_DOUBLE) */
+/*
+ * Convert arrays, e.g. for exporting positions in bulk
+ *
+ * Description
+ *
+ *	Element-wise dbl2sll, sll2dbl, and sll2dbl narrowed to float.  Each is
+ *	one multiply per element, with no calls in the loop.
+ */
 
-	/* Leading 1 is assumed by IEEE */
-	retval.u[1] = 0x40000000;
+void dbl2sll_array(const double *src, sll *dst, int n)
+{
+	int i;
+	double d;
+
+	for (i = 0; i < n; i++) {
+		d = src[i];
+		if (!(d == d))
+			dst[i] = CONST_0;
+		else if (d >= 2147483648.0)
+			dst[i] = CONST_MAX;
+		else if (d <= -2147483648.0)
+			dst[i] = CONST_MIN;
+		else
+			dst[i] = (sll) (d * 4294967296.0);
+	}
+}
 
-	/* Unpack the mantissa into the unsigned long */
-	retval.u[1] |= (in.u[1] << 10) & 0x3ffffc00;
-	retval.u[1] |= (in.u[0] >> 22) & 0x000003ff;
-	retval.u[0] = in.u[0] << 10;
+void sll2dbl_array(const sll *src, double *dst, int n)
+{
+	int i;
 
-	/* Extract the exponent and align the decimals */
-	exp = (in.u[1] >> 20) & 0x7ff;
-	if (exp)
-		/* IEEE 754 decimal begins at right of bit position 30 */
-		retval.ull >>= (1023 + 30) - exp;
-	else
-		return 0L;
+	for (i = 0; i < n; i++)
+		dst[i] = (double) src[i] * (1.0 / 4294967296.0);
+}
 
-	/* Negate if negative flag set */
-	if (in.u[1] & 0x80000000)
-		retval.sll = _sllneg(retval.sll);
+void sll2flt_array(const sll *src, float *dst, int n)
+{
+	int i;
 
-	return retval.sll;
+	for (i = 0; i < n; i++)
+		dst[i] = (float) ((double) src[i] * (1.0 / 4294967296.0));
 }
 
 /*
- * Pack fixed point sll format into IEEE 754 floating point double format
+ * Convert a decimal string into sll, exactly
  *
  * Description
  *
- *	IEEE 754 specifies the binary64 type ("double" in C) as having:
+ *	[space] [+|-] digits [. digits] [(e|E) [+|-] digits]
  *
- *	1 bit sign
- *	11 bit exponent
- *	53 bit significand
+ *	with at least one digit before or after the point.  The value is rounded
+ *	to the nearest multiple of 2^-32, ties away from zero, from the decimal
+ *	digits themselves; no double is involved, so the result is the same on
+ *	every platform, and the same as the C++ _fx literal.
  *
- *	The first bit of the significand is an implied 1 which is not stored.
- *	The decimal would be to the right of that implied 1, or to the left of
- *	the stored significand.
+ *	Rounding points are odd multiples of 2^-33 = 5^33 * 10^-33, which all
+ *	end within 33 decimal places.  So the fraction can be cut after 33
+ *	digits without moving the result to the other side of one.
  *
- *	The exponent is unsigned, and biased with an offset of 1023.
+ *	A fraction of up to 9 digits, f / 10^k, is converted with one divide,
+ *	(f * 2^32 + 10^k / 2) / 10^k, which fits in 64 bits.  Longer fractions
+ *	are doubled as a decimal string, one binary digit per step.
  *
- *	The IEEE 754 standard does not specify endianess, but the endian used is
- *	traditionally the same endian that the processor uses.
+ *	Returns the number of characters used, or 0 if there is no number or
+ *	it is outside the sll range; *out is only written on success.
  */
 
-double sll2dbl(sll s)
+#define _SLL_STR_FRAC	33	/* Fractional digits that can matter */
+#define _SLL_STR_KEEP	64	/* Significant digits kept, >= 10 + 33 */
+
+int str2sll(const char *s, sll *out)
 {
-	union {
-		double d;
-		unsigned u[2];
-		ull ull;
-		sll sll;
-	} in, retval;
-	register unsigned exp;
-	register unsigned flag;
+	static const ull pow10[10] = {
+		1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL,
+		1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL
+	};
+	const char *p = s;
+	char dig[_SLL_STR_KEEP];
+	char frac[_SLL_STR_FRAC];
+	int nd = 0;		/* Digits kept in dig[], first one non-zero */
+	int dp = 0;		/* Digits before the point, counted from dig[0] */
+	int seen = 0;
+	int neg = 0;
+	int nf;
+	int i;
+	ull ip = 0;
+	ull fp = 0;
+
+	while (*p == ' ' || (*p >= '\t' && *p <= '\r'))
+		p++;
+	if (*p == '+' || *p == '-')
+		neg = (*p++ == '-');
+
+	for (; *p >= '0' && *p <= '9'; p++) {
+		seen = 1;
+		if (nd == 0 && *p == '0')
+			continue;
+		if (nd < _SLL_STR_KEEP)
+			dig[nd++] = *p - '0';
+		dp++;
+	}
+	if (*p == '.') {
+		for (p++; *p >= '0' && *p <= '9'; p++) {
+			seen = 1;
+			if (nd == 0 && *p == '0') {
+				dp--;
+				continue;
+			}
+			if (nd < _SLL_STR_KEEP)
+				dig[nd++] = *p - '0';
+		}
+	}
+	if (!seen)
+		return 0;
 
-	if (s == 0)
-		return 0.0;
+	if (*p == 'e' || *p == 'E') {
+		const char *e = p + 1;
+		int eneg = 0;
+		int ev = 0;
+
+		if (*e == '+' || *e == '-')
+			eneg = (*e++ == '-');
+		if (*e >= '0' && *e <= '9') {
+			for (; *e >= '0' && *e <= '9'; e++)
+				if (ev < 10000)
+					ev = ev * 10 + (*e - '0');
+			dp += (eneg) ? -ev : ev;
+			p = e;
+		}
+	}
 
-	/* Move into memory as args might be passed in regs */
-	in.sll = s;
+	/* Integer part, at most 2^31 in magnitude */
+	if (nd > 0 && dp > 10)
+		return 0;
+	for (i = 0; i < dp; i++) {
+		ip = ip * 10 + ((i < nd) ? dig[i] : 0);
+		if (ip > 0x80000000ULL)
+			return 0;
+	}
 
-	/* Handle the negative flag */
-	if (in.sll < 1) {
-		flag = 0x80000000;
-		in.ull = _sllneg(in.sll);
-	} else
-		flag = 0x00000000;
+	/* Fractional digits, cut after _SLL_STR_FRAC and trailing zeros dropped */
+	nf = 0;
+	for (i = 0; i < _SLL_STR_FRAC; i++) {
+		int k = dp + i;
 
-	/*
-	 * Normalize
-	 *
-	 * IEEE 754 decimal-point begins at right of bit position 30
-	 */
-	for (exp = (1023 + 30); in.ull && (in.u[1] & 0x80000000) == 0; exp--) {
-		in.ull <<= 1;
+		frac[i] = (k >= 0 && k < nd) ? dig[k] : 0;
+		if (frac[i])
+			nf = i + 1;
+	}
+
+	if (nf <= 9) {
+		ull f = 0;
+
+		for (i = 0; i < nf; i++)
+			f = f * 10 + frac[i];
+		fp = ((f << 32) + pow10[nf] / 2) / pow10[nf];
+	} else {
+		int b;
+		int j;
+
+		for (b = 0; b < 33; b++) {
+			int carry = 0;
+
+			for (j = nf - 1; j >= 0; j--) {
+				int d = frac[j] * 2 + carry;
+
+				frac[j] = (char) (d % 10);
+				carry = d / 10;
+			}
+			fp = (fp << 1) | (ull) carry;
+		}
+		fp = (fp + 1) >> 1;
 	}
-	in.ull <<= 1;
-	exp++;
-	in.ull >>= 12;
-	retval.ull = in.ull;
-	retval.u[1] |= flag | (exp << 20);
 
-#if defined(BROKEN_IEEE754_DOUBLE)
+	fp += ip << 32;
+	if (fp > ((neg) ? 0x8000000000000000ULL : 0x7fffffffffffffffULL))
+		return 0;
 
-	exp = retval.u[0];
-	retval.u[0] = retval.u[1];
-	retval.u[1] = exp;
+	*out = (neg) ? (sll) (0 - fp) : (sll) fp;
+	return (int) (p - s);
+}
 
-#endif /* defined(BROKEN_IEEE754_DOUBLE)  */
+/*
+ * Convert sll into a decimal string
+ *
+ * Description
+ *
+ *	Writes [-] digits [. digits] and a terminating NUL into buf, which must
+ *	hold SLL_STR_MAX characters, and returns the length.
+ *
+ *	digits >= 0 gives exactly that many fractional digits.  digits < 0
+ *	gives up to -digits, without trailing zeros but keeping at least one.
+ *	At most 32 are written, which is enough for the exact value.
+ *
+ *	Only integer arithmetic is used: each fractional digit is the integer
+ *	part of ten times the remaining fraction, so every digit is exact, and
+ *	the remainder rounds the last one to nearest, ties away from zero.
+ *	A result that rounds to zero has no sign.
+ */
 
-	return retval.d;
+int sll2str(sll x, int digits, char *buf)
+{
+	char fd[32];
+	char id[10];
+	ull m = (x < 0) ? 0 - (ull) x : (ull) x;
+	ull ip = m >> 32;
+	ull f = m & 0xffffffffULL;
+	int trim = (digits < 0);
+	int nz;
+	int ni = 0;
+	int n = 0;
+	int i;
+
+	if (trim)
+		digits = -digits;
+	if (digits > 32)
+		digits = 32;
+
+	for (i = 0; i < digits; i++) {
+		f *= 10;
+		fd[i] = (char) ('0' + (f >> 32));
+		f &= 0xffffffffULL;
+	}
+	if (f >= 0x80000000ULL) {
+		for (i = digits - 1; i >= 0 && fd[i] == '9'; i--)
+			fd[i] = '0';
+		if (i >= 0)
+			fd[i]++;
+		else
+			ip++;
+	}
+	if (trim)
+		while (digits > 1 && fd[digits - 1] == '0')
+			digits--;
+
+	nz = (ip != 0);
+	for (i = 0; i < digits && !nz; i++)
+		nz = (fd[i] != '0');
+	if (x < 0 && nz)
+		buf[n++] = '-';
+
+	do {
+		id[ni++] = (char) ('0' + ip % 10);
+		ip /= 10;
+	} while (ip);
+	while (ni > 0)
+		buf[n++] = id[--ni];
+	if (digits > 0) {
+		buf[n++] = '.';
+		for (i = 0; i < digits; i++)
+			buf[n++] = fd[i];
+	}
+	buf[n] = '\0';
+	return n;
 }
 
 /*
@@ -209,57 +393,783 @@ double sll2dbl(sll s)
  *	Hence a custom multiply routine is required, to preserve the parts
  *	of the result that sll needs.
  *
- *	Consider two sll numbers, x and y:
+ *	Consider two sll numbers, x and y:
+ *
+ *	Let x = x_hi * 2^0 + x_lo * 2^(-32)
+ *	Let y = y_hi * 2^0 + y_lo * 2^(-32)
+ *
+ * 	Where:
+ *
+ *	*_hi is the signed 32 bit integer part to the left of the decimal
+ *	*_lo is the unsigned 32 bit fractional part to the right of the decimal
+ *
+ *	x * y = (x_hi * 2^0 + x_lo * 2^(-32))
+ *	      * (y_hi * 2^0 + y_lo * 2^(-32))
+ *
+ *	Expanding the terms, we get:
+ *
+ *	= x_hi * y_hi * 2^0 + x_hi * y_lo * 2^(-32)
+ *	+ x_lo * y_hi * 2^(-32) + x_lo * y_lo * 2^(-64)
+ *
+ *	Grouping by powers of 2, we get:
+ *
+ *	(x_hi * y_hi) * 2^0
+ *	We only need the low 32 bits of this term, as the rest is overflow
+ *
+ *	(x_hi * y_lo + x_lo * y_hi) * 2^-32
+ *	We need all bits of this term
+ *
+ *	x_lo * y_lo * 2^-64
+ *	We only need the high 32 bits of this term, as the rest is underflow
+ *
+ *	Where the compiler has a 128 bit integer type, the full product is
+ *	formed with one widening multiply and shifted instead.  Both give the
+ *	same bits, floor (x * y / 2^32) modulo 2^64.
+ */
+
+sll sllmul(sll x, sll y)
+{
+#if defined(SLL_MUL_ROUND)
+
+	return sllmul_rn(x, y);
+
+#elif defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x * y) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	register unsigned int x_lo;
+	register signed int x_hi;
+
+	register unsigned int y_lo;
+	register signed int y_hi;
+
+	x_hi = (signed int) ((ull) x >> 32);	// Discard lower 32 bits
+	x_lo = (unsigned int) x;		// Discard upper 32 bits
+
+	y_hi = (signed int) ((ull) y >> 32);	// Discard lower 32 bits
+	y_lo = (unsigned int) y;		// Discard upper 32 bits
+
+	return (sll) (
+		  ((ull) (x_hi * y_hi) << 32)
+		+ ((ull) x_hi * y_lo + x_lo * (ull) y_hi)
+		+ (((ull) x_lo * y_lo) >> 32)
+	);
+
+#endif /* defined(SLL_MUL_ROUND) */
+}
+
+/*
+ * Multiply two sll values, rounding to nearest
+ *
+ * Description
+ *
+ *	x * y = floor ((x * y + 2^31) / 2^32), so ties round up.
+ *
+ *	Let the 128 bit product be P = Q * 2^32 + R, where 0 <= R < 2^32.
+ *	Then the rounded result is Q + (R >= 2^31), and since every other
+ *	partial product is a multiple of 2^32, bit 31 of R is bit 31 of
+ *	x_lo * y_lo.  So rounding costs one extra shift and add over sllmul().
+ */
+
+sll sllmul_rn(sll x, sll y)
+{
+#if defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x * y + 0x80000000LL) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	register unsigned int x_lo;
+	register signed int x_hi;
+
+	register unsigned int y_lo;
+	register signed int y_hi;
+
+	register ull lo;
+
+	x_hi = (signed int) ((ull) x >> 32);	// Discard lower 32 bits
+	x_lo = (unsigned int) x;		// Discard upper 32 bits
+
+	y_hi = (signed int) ((ull) y >> 32);	// Discard lower 32 bits
+	y_lo = (unsigned int) y;		// Discard upper 32 bits
+
+	lo = (ull) x_lo * y_lo;
+
+	return (sll) (
+		  ((ull) (x_hi * y_hi) << 32)
+		+ ((ull) x_hi * y_lo + x_lo * (ull) y_hi)
+		+ (lo >> 32)
+		+ ((lo >> 31) & 1)
+	);
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+/*
+ * Sums of products
+ *
+ * Description
+ *
+ *	Each product x * y is exact in 128 bits as 64.64, so a sum of two to
+ *	four of them is formed without loss and chopped to 32.32 once, the same
+ *	way sllmul() chops a single product (rounded under SLL_MUL_ROUND).
+ *	Adding separate sllmul() results chops every term, and the sum can be
+ *	up to 2 ulp below the true value.
+ *
+ *	The result wraps modulo 2^64, like sllmul().
+ *
+ *	sllmla() has a single product, so it equals a + sllmul(x, y); it is
+ *	there to chain with the others without a temporary.
+ *
+ *	Without a 128 bit integer type, the products are formed from 32 bit
+ *	halves as in sllmul(), and the sums carried in a pair of 64 bit words.
+ */
+
+#if defined(SLL_MUL_ROUND)
+#  define _SLL_CHOP_BIAS	0x80000000ULL
+#else
+#  define _SLL_CHOP_BIAS	0ULL
+#endif /* defined(SLL_MUL_ROUND) */
+
+#if !defined(SLL_HAS_INT128)
+
+typedef struct {
+	ull hi;
+	ull lo;
+} _sllwide;
+
+/* Unsigned 64 x 64 -> 128 bit product */
+static _sllwide _sllwide_umul(ull x, ull y)
+{
+	_sllwide r;
+	ull x_lo = (unsigned int) x, x_hi = x >> 32;
+	ull y_lo = (unsigned int) y, y_hi = y >> 32;
+	ull ll = x_lo * y_lo;
+	ull lh = x_lo * y_hi;
+	ull hl = x_hi * y_lo;
+	ull mid = (ll >> 32) + (unsigned int) lh + (unsigned int) hl;
+
+	r.lo = (mid << 32) | (unsigned int) ll;
+	r.hi = x_hi * y_hi + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	return r;
+}
+
+/* Two's complement 128 bit product of signed x and y */
+static _sllwide _sllwide_mul(sll x, sll y)
+{
+	_sllwide r = _sllwide_umul((ull) x, (ull) y);
+
+	if (x < 0)
+		r.hi -= (ull) y;
+	if (y < 0)
+		r.hi -= (ull) x;
+	return r;
+}
+
+static _sllwide _sllwide_add(_sllwide a, _sllwide b)
+{
+	a.lo += b.lo;
+	a.hi += b.hi + (a.lo < b.lo);
+	return a;
+}
+
+static _sllwide _sllwide_sub(_sllwide a, _sllwide b)
+{
+	_sllwide r;
+
+	r.lo = a.lo - b.lo;
+	r.hi = a.hi - b.hi - (a.lo < b.lo);
+	return r;
+}
+
+static int _sllwide_ge(_sllwide a, _sllwide b)
+{
+	return (a.hi != b.hi) ? (a.hi > b.hi) : (a.lo >= b.lo);
+}
+
+/* Bits 32..95, as sll */
+static sll _sllwide_chop(_sllwide s)
+{
+	_sllwide bias = {0, _SLL_CHOP_BIAS};
+
+	s = _sllwide_add(s, bias);
+	return (sll) ((s.hi << 32) | (s.lo >> 32));
+}
+
+#endif /* !defined(SLL_HAS_INT128) */
+
+sll sllmla(sll a, sll x, sll y)
+{
+#if defined(SLL_HAS_INT128)
+
+	return (sll) ((((sll128) a << 32) + (sll128) x * y + _SLL_CHOP_BIAS) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	_sllwide s = _sllwide_mul(x, y);
+
+	return _slladd(a, _sllwide_chop(s));
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+sll slldot2(sll x0, sll y0, sll x1, sll y1)
+{
+#if defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x0 * y0 + (sll128) x1 * y1 + _SLL_CHOP_BIAS) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	return _sllwide_chop(_sllwide_add(_sllwide_mul(x0, y0), _sllwide_mul(x1, y1)));
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+sll slldot3(sll x0, sll y0, sll x1, sll y1, sll x2, sll y2)
+{
+#if defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x0 * y0 + (sll128) x1 * y1 + (sll128) x2 * y2
+		+ _SLL_CHOP_BIAS) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	_sllwide s = _sllwide_add(_sllwide_mul(x0, y0), _sllwide_mul(x1, y1));
+
+	return _sllwide_chop(_sllwide_add(s, _sllwide_mul(x2, y2)));
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+sll slldot4(sll x0, sll y0, sll x1, sll y1, sll x2, sll y2, sll x3, sll y3)
+{
+#if defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x0 * y0 + (sll128) x1 * y1 + (sll128) x2 * y2
+		+ (sll128) x3 * y3 + _SLL_CHOP_BIAS) >> 32);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	_sllwide s = _sllwide_add(_sllwide_mul(x0, y0), _sllwide_mul(x1, y1));
+
+	s = _sllwide_add(s, _sllwide_mul(x2, y2));
+	return _sllwide_chop(_sllwide_add(s, _sllwide_mul(x3, y3)));
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+/*
+ * Multiply two values with f fractional bits
+ *
+ * Description
+ *
+ *	The same as sllmul(), for any format with 0 <= f <= 63 fractional bits
+ *	in 64: the 128 bit product is shifted right by f, rounded to nearest
+ *	under SLL_MUL_ROUND, and wraps modulo 2^64.  sllqmul(x, y, 32) is
+ *	sllmul(x, y).
+ */
+
+sll sllqmul(sll x, sll y, int f)
+{
+	ull bias = 0;
+
+#if defined(SLL_MUL_ROUND)
+	if (f > 0)
+		bias = (ull) 1 << (f - 1);
+#endif /* defined(SLL_MUL_ROUND) */
+
+#if defined(SLL_HAS_INT128)
+
+	return (sll) (((sll128) x * y + bias) >> f);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	_sllwide p = _sllwide_mul(x, y);
+	_sllwide b = {0, bias};
+
+	p = _sllwide_add(p, b);
+	if (f == 0)
+		return (sll) p.lo;
+	return (sll) ((p.hi << (64 - f)) | (p.lo >> f));
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+/*
+ * SIMD lanes for the *_array kernels
+ *
+ * Description
+ *
+ *	A lane multiply forms the same sum as the portable sllmul(), from
+ *	unsigned 32 x 32 -> 64 bit products:
+ *
+ *	x * y = (x_hi * y_hi) << 32 + x_hi * y_lo + x_lo * y_hi
+ *	      + (x_lo * y_lo) >> 32			(modulo 2^64)
+ *
+ *	An unsigned product reads a negative x_hi as x_hi + 2^32, which adds
+ *	y_lo * 2^32 too much, and likewise for y_hi.  Only the low 32 bits of
+ *	x_hi * y_hi survive its shift, so both corrections are subtracted there.
+ *	Adds, compares and the wrapping sum of a dot product are exact in any
+ *	order, so every kernel gives the same bits as its scalar loop.
+ *
+ *	Each routine does a whole number of vectors and returns how many
+ *	elements that was; the scalar loop in the caller does the rest.
+ */
+
+#if defined(SLL_SIMD_AVX2)
+
+#define _SLL_AVX2		__attribute__((target("avx2")))
+#define _SLL_LOAD(p)		_mm256_loadu_si256((const __m256i *) (p))
+#define _SLL_STORE(p, v)	_mm256_storeu_si256((__m256i *) (p), (v))
+
+static int _sll_have_avx2(void)
+{
+	static int have = -1;
+
+	if (have < 0) {
+		__builtin_cpu_init();
+		have = __builtin_cpu_supports("avx2") ? 1 : 0;
+	}
+	return have;
+}
+
+static _SLL_AVX2 __inline__ __m256i _sllmul_avx2(__m256i x, __m256i y)
+{
+	__m256i zero = _mm256_setzero_si256();
+	__m256i x_hi = _mm256_srli_epi64(x, 32);
+	__m256i y_hi = _mm256_srli_epi64(y, 32);
+	__m256i lo = _mm256_mul_epu32(x, y);
+	__m256i hi = _mm256_mul_epu32(x_hi, y_hi);
+	__m256i r;
+
+	hi = _mm256_sub_epi64(hi, _mm256_and_si256(_mm256_cmpgt_epi64(zero, x), y));
+	hi = _mm256_sub_epi64(hi, _mm256_and_si256(_mm256_cmpgt_epi64(zero, y), x));
+	r = _mm256_add_epi64(_mm256_mul_epu32(x_hi, y), _mm256_mul_epu32(x, y_hi));
+	r = _mm256_add_epi64(r, _mm256_slli_epi64(hi, 32));
+	r = _mm256_add_epi64(r, _mm256_srli_epi64(lo, 32));
+#if defined(SLL_MUL_ROUND)
+	r = _mm256_add_epi64(r, _mm256_and_si256(_mm256_srli_epi64(lo, 31),
+		_mm256_set1_epi64x(1)));
+#endif /* defined(SLL_MUL_ROUND) */
+	return r;
+}
+
+static _SLL_AVX2 int _sllaxpy_avx2(const sll *x, sll a, sll *y, int n)
+{
+	__m256i va = _mm256_set1_epi64x(a);
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_SLL_STORE(y + i, _mm256_add_epi64(_SLL_LOAD(y + i),
+			_sllmul_avx2(_SLL_LOAD(x + i), va)));
+	return i;
+}
+
+static _SLL_AVX2 int _slladd_avx2(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_SLL_STORE(y + i, _mm256_add_epi64(_SLL_LOAD(y + i),
+			_SLL_LOAD(x + i)));
+	return i;
+}
+
+static _SLL_AVX2 int _sllscale_avx2(sll a, sll *y, int n)
+{
+	__m256i va = _mm256_set1_epi64x(a);
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_SLL_STORE(y + i, _sllmul_avx2(_SLL_LOAD(y + i), va));
+	return i;
+}
+
+static _SLL_AVX2 int _sllmul_array_avx2(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		_SLL_STORE(y + i, _sllmul_avx2(_SLL_LOAD(y + i),
+			_SLL_LOAD(x + i)));
+	return i;
+}
+
+static _SLL_AVX2 int _slllerp_avx2(const sll *x, sll t, sll *y, int n)
+{
+	__m256i vt = _mm256_set1_epi64x(t);
+	__m256i vy;
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		vy = _SLL_LOAD(y + i);
+		_SLL_STORE(y + i, _mm256_add_epi64(vy, _sllmul_avx2(
+			_mm256_sub_epi64(_SLL_LOAD(x + i), vy), vt)));
+	}
+	return i;
+}
+
+static _SLL_AVX2 int _sllclamp_avx2(sll lo, sll hi, sll *y, int n)
+{
+	__m256i vlo = _mm256_set1_epi64x(lo);
+	__m256i vhi = _mm256_set1_epi64x(hi);
+	__m256i vy, r;
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4) {
+		vy = _SLL_LOAD(y + i);
+		r = _mm256_blendv_epi8(vy, vhi, _mm256_cmpgt_epi64(vy, vhi));
+		r = _mm256_blendv_epi8(r, vlo, _mm256_cmpgt_epi64(vlo, vy));
+		_SLL_STORE(y + i, r);
+	}
+	return i;
+}
+
+static _SLL_AVX2 int _slldot_avx2(const sll *x, const sll *y, int n, sll *sum)
+{
+	__m256i acc = _mm256_setzero_si256();
+	__m128i s;
+	int i;
+
+	for (i = 0; i + 4 <= n; i += 4)
+		acc = _mm256_add_epi64(acc, _sllmul_avx2(_SLL_LOAD(x + i),
+			_SLL_LOAD(y + i)));
+	s = _mm_add_epi64(_mm256_castsi256_si128(acc),
+		_mm256_extracti128_si256(acc, 1));
+	s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+	_mm_storel_epi64((__m128i *) sum, s);
+	return i;
+}
+
+#define _SLL_SIMD(f, args)	(_sll_have_avx2() ? f##_avx2 args : 0)
+
+#elif defined(SLL_SIMD_NEON)
+
+static __inline__ int64x2_t _sllmul_neon(int64x2_t x, int64x2_t y)
+{
+	uint64x2_t ux = vreinterpretq_u64_s64(x);
+	uint64x2_t uy = vreinterpretq_u64_s64(y);
+	uint32x2_t x_lo = vmovn_u64(ux);
+	uint32x2_t x_hi = vshrn_n_u64(ux, 32);
+	uint32x2_t y_lo = vmovn_u64(uy);
+	uint32x2_t y_hi = vshrn_n_u64(uy, 32);
+	uint64x2_t lo = vmull_u32(x_lo, y_lo);
+	uint32x2_t hi = vmul_u32(x_hi, y_hi);
+	uint64x2_t r;
+
+	hi = vsub_u32(hi, vand_u32(vreinterpret_u32_s32(
+		vshr_n_s32(vreinterpret_s32_u32(x_hi), 31)), y_lo));
+	hi = vsub_u32(hi, vand_u32(vreinterpret_u32_s32(
+		vshr_n_s32(vreinterpret_s32_u32(y_hi), 31)), x_lo));
+	r = vmlal_u32(vmull_u32(x_hi, y_lo), x_lo, y_hi);
+	r = vaddq_u64(r, vshll_n_u32(hi, 32));
+	r = vsraq_n_u64(r, lo, 32);
+#if defined(SLL_MUL_ROUND)
+	r = vaddq_u64(r, vandq_u64(vshrq_n_u64(lo, 31), vdupq_n_u64(1)));
+#endif /* defined(SLL_MUL_ROUND) */
+	return vreinterpretq_s64_u64(r);
+}
+
+static int _sllaxpy_neon(const sll *x, sll a, sll *y, int n)
+{
+	int64x2_t va = vdupq_n_s64(a);
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		vst1q_s64(y + i, vaddq_s64(vld1q_s64(y + i),
+			_sllmul_neon(vld1q_s64(x + i), va)));
+	return i;
+}
+
+static int _slladd_neon(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		vst1q_s64(y + i, vaddq_s64(vld1q_s64(y + i), vld1q_s64(x + i)));
+	return i;
+}
+
+static int _sllscale_neon(sll a, sll *y, int n)
+{
+	int64x2_t va = vdupq_n_s64(a);
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		vst1q_s64(y + i, _sllmul_neon(vld1q_s64(y + i), va));
+	return i;
+}
+
+static int _sllmul_array_neon(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		vst1q_s64(y + i, _sllmul_neon(vld1q_s64(y + i), vld1q_s64(x + i)));
+	return i;
+}
+
+static int _slllerp_neon(const sll *x, sll t, sll *y, int n)
+{
+	int64x2_t vt = vdupq_n_s64(t);
+	int64x2_t vy;
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		vy = vld1q_s64(y + i);
+		vst1q_s64(y + i, vaddq_s64(vy, _sllmul_neon(
+			vsubq_s64(vld1q_s64(x + i), vy), vt)));
+	}
+	return i;
+}
+
+static int _sllclamp_neon(sll lo, sll hi, sll *y, int n)
+{
+	int64x2_t vlo = vdupq_n_s64(lo);
+	int64x2_t vhi = vdupq_n_s64(hi);
+	int64x2_t vy, r;
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2) {
+		vy = vld1q_s64(y + i);
+		r = vbslq_s64(vcgtq_s64(vy, vhi), vhi, vy);
+		r = vbslq_s64(vcltq_s64(vy, vlo), vlo, r);
+		vst1q_s64(y + i, r);
+	}
+	return i;
+}
+
+static int _slldot_neon(const sll *x, const sll *y, int n, sll *sum)
+{
+	int64x2_t acc = vdupq_n_s64(0);
+	int i;
+
+	for (i = 0; i + 2 <= n; i += 2)
+		acc = vaddq_s64(acc, _sllmul_neon(vld1q_s64(x + i),
+			vld1q_s64(y + i)));
+	*sum = (sll) ((ull) vgetq_lane_s64(acc, 0)
+		+ (ull) vgetq_lane_s64(acc, 1));
+	return i;
+}
+
+#define _SLL_SIMD(f, args)	f##_neon args
+
+#else /* !defined(SLL_SIMD_AVX2) && !defined(SLL_SIMD_NEON) */
+
+#define _SLL_SIMD(f, args)	0
+
+#endif /* defined(SLL_SIMD_AVX2) */
+
+/*
+ * Element-wise kernels over sll lanes, e.g. one coordinate of many vectors
+ *
+ * Description
+ *
+ *	sllaxpy_array:	y[i] = y[i] + a * x[i]
+ *	slladd_array:	y[i] = y[i] + x[i]
+ *	sllscale_array:	y[i] = a * y[i]
+ *	sllmul_array:	y[i] = x[i] * y[i]
+ *	slllerp_array:	y[i] = y[i] + (x[i] - y[i]) * t, t is not clamped
+ *	sllclamp_array:	y[i] = lo if y[i] < lo, else hi if y[i] > hi
+ *	slldot_array:	x[0] * y[0] + ... + x[n-1] * y[n-1], wrapping
+ *
+ *	Each result is bit-identical to the same sllmul/slladd on one element,
+ *	so a batch update matches the per-object code exactly.
+ */
+
+void sllaxpy_array(const sll *x, sll a, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_sllaxpy, (x, a, y, n)); i < n; i++)
+		y[i] = _slladd(y[i], sllmul(x[i], a));
+}
+
+void slladd_array(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_slladd, (x, y, n)); i < n; i++)
+		y[i] = _slladd(y[i], x[i]);
+}
+
+void sllscale_array(sll a, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_sllscale, (a, y, n)); i < n; i++)
+		y[i] = sllmul(y[i], a);
+}
+
+void sllmul_array(const sll *x, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_sllmul_array, (x, y, n)); i < n; i++)
+		y[i] = sllmul(y[i], x[i]);
+}
+
+void slllerp_array(const sll *x, sll t, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_slllerp, (x, t, y, n)); i < n; i++)
+		y[i] = _slladd(y[i], sllmul(_sllsub(x[i], y[i]), t));
+}
+
+void sllclamp_array(sll lo, sll hi, sll *y, int n)
+{
+	int i;
+
+	for (i = _SLL_SIMD(_sllclamp, (lo, hi, y, n)); i < n; i++) {
+		if (y[i] < lo)
+			y[i] = lo;
+		else if (y[i] > hi)
+			y[i] = hi;
+	}
+}
+
+sll slldot_array(const sll *x, const sll *y, int n)
+{
+	sll sum = 0;
+	int i;
+
+	for (i = _SLL_SIMD(_slldot, (x, y, n, &sum)); i < n; i++)
+		sum = _slladd(sum, sllmul(x[i], y[i]));
+	return sum;
+}
+
+#if defined(SLL_TRIG_TABLE)
+
+/*
+ * Split x into a table angle and a small remainder, where 0 <= x <= pi/4
+ *
+ * Description
+ *
+ *	x = k * h + d
  *
- *	Let x = x_hi * 2^0 + x_lo * 2^(-32)
- *	Let y = y_hi * 2^0 + y_lo * 2^(-32)
+ *	Where:
  *
- * 	Where:
+ *	h = pi / 512 is the table step
+ *	k is the nearest table index, 0 <= k <= 128
+ *	|d| <= h / 2 ~= 0.00307
  *
- *	*_hi is the signed 32 bit integer part to the left of the decimal
- *	*_lo is the unsigned 32 bit fractional part to the right of the decimal
+ *	k * h is formed from the 0.64 step, so d carries no error from the
+ *	rounding of h.  sin d and cos d then need only two terms:
  *
- *	x * y = (x_hi * 2^0 + x_lo * 2^(-32))
- *	      * (y_hi * 2^0 + y_lo * 2^(-32))
+ *	sin d = d - d^3 / 3!	(d^5 / 5! < 2^-40)
+ *	cos d = 1 - d^2 / 2!	(d^4 / 4! < 2^-37)
  *
- *	Expanding the terms, we get:
+ *	Since |d| < 2^-8, the remainder is returned as D = d * 2^8, which keeps
+ *	8 extra bits through the correction terms.  D2 = D^2 = d^2 * 2^16 and
+ *	SD = sin d * 2^8 are returned alongside.
+ */
+
+static int _sllsplit(sll x, sll *d2, sll *sd)
+{
+	int k;
+	sll d;
+
+	k = _sll2int(_slladd(sllmul(x, CONST_512_PI), CONST_1_2));
+	d = _sllmul2n(_sllsub(x, (sll) (((ull) k * SLL_SINTAB_STEP + 0x80000000ULL) >> 32)), 8);
+
+	*d2 = sllmul(d, d);
+	*sd = _sllsub(d, _slldiv2n(sllmul(d, sllmul(*d2, CONST_1_6)), 16));
+
+	return k;
+}
+
+/*
+ * Calculate cos x where -pi/4 <= x <= pi/4
  *
- *	= x_hi * y_hi * 2^0 + x_hi * y_lo * 2^(-32)
- *	+ x_lo * y_hi * 2^(-32) + x_lo * y_lo * 2^(-64)
+ * Description
  *
- *	Grouping by powers of 2, we get:
+ *	cos (k * h + d) = cos (k * h) * cos d - sin (k * h) * sin d
+ *			= cos (k * h) - (cos (k * h) * d^2 / 2 + sin (k * h) * sin d)
  *
- *	(x_hi * y_hi) * 2^0
- *	We only need the low 32 bits of this term, as the rest is overflow
+ *	Both cos (k * h) and sin (k * h) come from the quarter-wave table, see
+ *	tools/gen-sll-sintab.c.  The correction is summed at 2^-40 and rounded
+ *	once.  This is 7 multiplies instead of the 12 needed by the series.
+ */
+
+sll _sllcos(sll x)
+{
+	int k;
+	sll d2;
+	sll sd;
+	sll s;
+	sll c;
+
+	/* cos -x = cos x */
+	k = _sllsplit(sllabs(x), &d2, &sd);
+	s = sll_sintab[k];
+	c = sll_sintab[SLL_SINTAB_SIZE - k];
+
+	return _sllsub(c, _slldiv2n(_slladd(_slladd(
+		_slldiv2n(sllmul(c, d2), 9), sllmul(s, sd)), 0x80), 8));
+}
+
+/*
+ * Calculate sin x where -pi/4 <= x <= pi/4
  *
- *	(x_hi * y_lo + x_lo * y_hi) * 2^-32
- *	We need all bits of this term
+ * Description
  *
- *	x_lo * y_lo * 2^-64
- *	We only need the high 32 bits of this term, as the rest is underflow
+ *	sin (k * h + d) = sin (k * h) * cos d + cos (k * h) * sin d
+ *			= sin (k * h) + (cos (k * h) * sin d - sin (k * h) * d^2 / 2)
  */
 
-sll sllmul(sll x, sll y)
+sll _sllsin(sll x)
 {
-	register unsigned int x_lo;
-	register signed int x_hi;
+	int k;
+	sll d2;
+	sll sd;
+	sll s;
+	sll c;
+	sll retval;
 
-	register unsigned int y_lo;
-	register signed int y_hi;
+	/* sin -x = -sin x */
+	k = _sllsplit(sllabs(x), &d2, &sd);
+	s = sll_sintab[k];
+	c = sll_sintab[SLL_SINTAB_SIZE - k];
 
-	x_hi = (signed int) ((ull) x >> 32);	// Discard lower 32 bits
-	x_lo = (unsigned int) x;		// Discard upper 32 bits
+	retval = _slladd(s, _slldiv2n(_slladd(_sllsub(
+		sllmul(c, sd), _slldiv2n(sllmul(s, d2), 9)), 0x80), 8));
 
-	y_hi = (signed int) ((ull) y >> 32);	// Discard lower 32 bits
-	y_lo = (unsigned int) y;		// Discard upper 32 bits
+	return ((x < 0) ? _sllneg(retval): retval);
+}
 
-	return (sll) (
-		  ((ull) (x_hi * y_hi) << 32)
-		+ ((ull) x_hi * y_lo + x_lo * (ull) y_hi)
-		+ (((ull) x_lo * y_lo) >> 32)
-	);
+/*
+ * Calculate sin x and cos x where -pi/4 <= x <= pi/4
+ *
+ * Description
+ *
+ *	One split and one pair of table reads serve both results.
+ */
+
+void _sllsincos(sll x, sll *ps, sll *pc)
+{
+	int k;
+	sll d2;
+	sll sd;
+	sll s;
+	sll c;
+
+	k = _sllsplit(sllabs(x), &d2, &sd);
+	s = sll_sintab[k];
+	c = sll_sintab[SLL_SINTAB_SIZE - k];
+
+	*pc = _sllsub(c, _slldiv2n(_slladd(_slladd(
+		_slldiv2n(sllmul(c, d2), 9), sllmul(s, sd)), 0x80), 8));
+	s = _slladd(s, _slldiv2n(_slladd(_sllsub(
+		sllmul(c, sd), _slldiv2n(sllmul(s, d2), 9)), 0x80), 8));
+	*ps = ((x < 0) ? _sllneg(s): s);
 }
 
+#else /* !defined(SLL_TRIG_TABLE) */
+
 /*
  * Calculate cos x where -pi/4 <= x <= pi/4
  *
@@ -352,6 +1262,38 @@ sll _sllsin(sll x)
 	return retval;
 }
 
+/*
+ * Calculate sin x and cos x where -pi/4 <= x <= pi/4
+ *
+ * Description
+ *
+ *	Both series run over the same x^2, see _sllcos() and _sllsin().
+ */
+
+void _sllsincos(sll x, sll *ps, sll *pc)
+{
+	sll s;
+	sll c;
+	sll x2;
+
+	x2 = sllmul(x, x);
+
+	c = _sllsub(CONST_1, sllmul(x2, CONST_1_132));
+	s = _sllsub(x, sllmul(x2, CONST_1_156));
+	c = _sllsub(CONST_1, sllmul(sllmul(x2, c), CONST_1_90));
+	s = _sllsub(x, sllmul(sllmul(x2, s), CONST_1_110));
+	c = _sllsub(CONST_1, sllmul(sllmul(x2, c), CONST_1_56));
+	s = _sllsub(x, sllmul(sllmul(x2, s), CONST_1_72));
+	c = _sllsub(CONST_1, sllmul(sllmul(x2, c), CONST_1_30));
+	s = _sllsub(x, sllmul(sllmul(x2, s), CONST_1_42));
+	c = _sllsub(CONST_1, sllmul(sllmul(x2, c), CONST_1_12));
+	s = _sllsub(x, sllmul(sllmul(x2, s), CONST_1_20));
+	*pc = _sllsub(CONST_1, slldiv2(sllmul(x2, c)));
+	*ps = _sllsub(x, sllmul(sllmul(x2, s), CONST_1_6));
+}
+
+#endif /* defined(SLL_TRIG_TABLE) */
+
 /*
  * Calculate cos x for any value of x, by quadrant
  */
@@ -418,6 +1360,48 @@ sll sllsin(sll x)
 	return retval;
 }
 
+/*
+ * Calculate sin x and cos x for any value of x, by quadrant
+ *
+ * Description
+ *
+ *	Same results as sllsin() and sllcos(), but the range reduction and the
+ *	x^2 powers are shared between the two.
+ */
+
+void sllsincos(sll x, sll *ps, sll *pc)
+{
+	int i;
+	sll s;
+	sll c;
+
+	/* Calculate for (x - i * pi/2), where -pi/4 <= x - i * pi/2 <= pi/4 */
+	i = _sll2int(_slladd(sllmul(x, CONST_2_PI), CONST_1_2));
+	x = _sllsub(x, sllmul(_int2sll(i), CONST_PI_2));
+	_sllsincos(x, &s, &c);
+
+	/* Locate the quadrant */
+	switch (i & 3) {
+		default:
+		case 0:
+			*ps = s;
+			*pc = c;
+			break;
+		case 1:
+			*ps = c;
+			*pc = _sllneg(s);
+			break;
+		case 2:
+			*ps = _sllneg(s);
+			*pc = _sllneg(c);
+			break;
+		case 3:
+			*ps = _sllneg(c);
+			*pc = s;
+			break;
+	}
+}
+
 /*
  * Calculate tan x for any value of x, by quadrant
  */
@@ -446,6 +1430,8 @@ sll slltan(sll x)
 	return retval;
 }
 
+#if defined(SLL_ASIN_ITERATIVE)
+
 /*
  *
  * Calculate asin x, where |x| <= 1
@@ -528,205 +1514,609 @@ sll sllasin(sll x)
 }
 
 /*
- * Calculate atan x
+ * Calculate acos x, where |x| <= 1
+ *
+ * Description
+ *
+ *	acos x = pi / 2 - asin x
+ */
+
+sll sllacos(sll x)
+{
+	return _sllsub(CONST_PI_2, sllasin(x));
+}
+
+#else /* !defined(SLL_ASIN_ITERATIVE) */
+
+/*
+ * Calculate asin s, where 0 <= s <= 1 / 2 and z = s^2
+ *
+ * Description
+ *
+ *	asin s = s + s * z * R(z)
+ *
+ *	R is a degree 7 polynomial in z, from Chebyshev interpolation of
+ *	(asin s - s) / s^3 over 0 <= z <= 1 / 4.  With coefficients rounded to
+ *	sll, it is within 0.48 * 2^-32 of R, and s * z <= 1 / 4 scales that
+ *	down further.
+ *
+ *	The leading coefficient is 1 / 6, as in the series.
+ */
+
+static const sll _sllasin_tab[8] = {
+	0x000000002aaaaaabLL,
+	0x000000001333334dLL,
+	0x000000000b6dae7eLL,
+	0x0000000007c823acLL,
+	0x0000000005aa78caLL,
+	0x0000000004f1414fLL,
+	0x000000000164b97eLL,
+	0x0000000007808c56LL,
+};
+
+static sll _sllasin(sll s, sll z)
+{
+	int i;
+	sll r;
+
+	r = _sllasin_tab[7];
+	for (i = 6; i >= 0; i--)
+		r = _slladd(_sllasin_tab[i], sllmul(r, z));
+
+	return _slladd(s, sllmul_rn(s, sllmul_rn(z, r)));
+}
+
+/*
+ * Calculate acos x, where 1 / 2 < x <= 1
+ *
+ * Description
+ *
+ *	acos x = 2 * asin ((1 - x) / 2)^(1 / 2)
+ *
+ *	Letting z = (1 - x) / 2, and t = 2 * z^(1 / 2) = (4 * z)^(1 / 2):
+ *	acos x = t + t * z * R(z)
+ *
+ *	t comes from sllrsqrt and one Newton step on the remainder:
+ *	t = v * r + (v - (v * r)^2) * r / 2, where v = 4 * z, r = v^(-1 / 2)
+ *
+ *	v < 1, so t^2 and the remainder are formed exactly in 2^-64 units;
+ *	otherwise the remainder would vanish for the tiny t next to x = 1.
+ *	No cancellation, so the error stays small as x approaches 1.
+ */
+
+static sll _sllacos(sll x)
+{
+	sll v;
+	sll r;
+	sll t;
+	sll d;
+
+	v = _sllmul2(_sllsub(CONST_1, x));
+	r = sllrsqrt(v);
+	t = sllmul(v, r);
+	d = (sll) (((ull) v << 32) - (ull) t * (ull) t);
+	t = _slladd(t, _slldiv2n(_slladd(sllmul(d, r), CONST_1), 33));
+
+	return _sllasin(t, _slldiv4(v));
+}
+
+/*
+ * Calculate asin x, where |x| <= 1
+ *
+ * Description
+ *
+ *	asin -x = -asin x
+ *
+ *	|x| <= 1 / 2:
+ *	asin x = x + x^3 * R(x^2), see _sllasin()
+ *
+ *	1 / 2 < |x| <= 1:
+ *	asin x = pi / 2 - acos x, see _sllacos()
+ *
+ *	One reciprocal square root and no trigonometric calls.  Measured
+ *	against long double over [-1, 1], the error is below 1.72 * 2^-32.
+ *	Part of that is CONST_PI_2 itself being chopped.
+ *
+ *	|x| > 1 returns 0.
+ */
+
+sll sllasin(sll x)
+{
+	int left_side;
+	sll retval;
+
+	/* asin -x = -asin x */
+	if ((left_side = x < 0))
+		x = _sllneg(x);
+
+	/* Out-of-range */
+	if (x > CONST_1)
+		return 0;
+
+	if (x <= CONST_1_2)
+		retval = _sllasin(x, sllmul(x, x));
+	else
+		retval = _sllsub(CONST_PI_2, _sllacos(x));
+
+	/* Negate result if necessary */
+	return (left_side ? _sllneg(retval): retval);
+}
+
+/*
+ * Calculate acos x, where |x| <= 1
+ *
+ * Description
+ *
+ *	acos -x = pi - acos x
+ *
+ *	|x| <= 1 / 2:
+ *	acos x = pi / 2 - asin x, see _sllasin()
+ *
+ *	1 / 2 < |x| <= 1:
+ *	See _sllacos()
+ *
+ *	Measured error below 1.98 * 2^-32, see sllasin().
+ *
+ *	|x| > 1 returns pi / 2.
+ */
+
+sll sllacos(sll x)
+{
+	int left_side;
+	sll retval;
+
+	/* acos -x = pi - acos x */
+	if ((left_side = x < 0))
+		x = _sllneg(x);
+
+	/* Out-of-range */
+	if (x > CONST_1)
+		return CONST_PI_2;
+
+	if (x <= CONST_1_2)
+		retval = _sllsub(CONST_PI_2, _sllasin(x, sllmul(x, x)));
+	else
+		retval = _sllacos(x);
+
+	return (left_side ? _sllsub(CONST_PI, retval): retval);
+}
+
+#endif /* defined(SLL_ASIN_ITERATIVE) */
+
+/*
+ * CORDIC angles atan 2^-i, in units of 2^-61 radians
+ */
+
+#define SLLATAN2_STEPS	17
+
+static const sll _sllatan2_tab[SLLATAN2_STEPS] = {
+	0x1921fb54442d1847LL,	// atan 2^-0
+	0x0ed63382b0dda7b4LL,	// atan 2^-1
+	0x07d6dd7e4b203759LL,	// atan 2^-2
+	0x03fab7535585edb9LL,	// atan 2^-3
+	0x01ff55bb72cfde9cLL,	// atan 2^-4
+	0x00ffeaaddd4bb125LL,	// atan 2^-5
+	0x007ffd556eedca6bLL,	// atan 2^-6
+	0x003fffaaab77752eLL,	// atan 2^-7
+	0x001ffff5555bbbb7LL,	// atan 2^-8
+	0x000ffffeaaaadddeLL,	// atan 2^-9
+	0x0007ffffd55556efLL,	// atan 2^-10
+	0x0003fffffaaaaab7LL,	// atan 2^-11
+	0x0001ffffff555556LL,	// atan 2^-12
+	0x0000ffffffeaaaabLL,	// atan 2^-13
+	0x00007ffffffd5555LL,	// atan 2^-14
+	0x00003fffffffaaabLL,	// atan 2^-15
+	0x00001ffffffff555LL,	// atan 2^-16
+};
+
+#define SLLATAN2_PI	0x6487ed5110b4611aLL	// PI, units of 2^-61
+#define SLLATAN2_PI_2	0x3243f6a8885a308dLL	// PI / 2, units of 2^-61
+
+/*
+ * Calculate atan (y / x), by quadrant
+ *
+ * Description
+ *
+ *	The result lies in -pi < atan2 (y, x) <= pi, and atan2 (0, 0) = 0.
+ *
+ *	The vector (|x|, |y|) is folded into the first octant, 0 <= y <= x, and
+ *	its length is scaled so the larger component lies in [2^60, 2^61), which
+ *	makes the angle independent of the magnitude of the inputs and leaves
+ *	room for the CORDIC gain (1.647 * sqrt 2 < 4).
+ *
+ *	CORDIC in vectoring mode then rotates the vector onto the x-axis, using
+ *	only shifts and adds:
+ *
+ *	if y > 0:  x, y, z = x + y * 2^-i, y - x * 2^-i, z + atan 2^-i
+ *	otherwise: x, y, z = x - y * 2^-i, y + x * 2^-i, z - atan 2^-i
+ *
+ *	After 17 steps the remaining angle t is below 2^-16, so that
+ *	atan t = y / x to within t^3 / 3 < 2^-49, and a single integer division
+ *	finishes the job.  The angle and the octant unfolding are carried at
+ *	2^-61, and rounded to sll once.
+ *
+ *	The CORDIC loop has no multiplies and no branches, the rotation
+ *	direction is applied as a sign mask.  Around it, the octant fold and
+ *	unfold branch on the signs of x and y and on |y| > |x|, and the
+ *	remaining angle costs one 64-bit division.  Max error is 0.5 ulp.
+ */
+
+sll sllatan2(sll y, sll x)
+{
+	ull ax;
+	ull ay;
+	ull t;
+	sll xn;
+	sll yn;
+	sll z;
+	int swap;
+	int n;
+	int i;
+
+	ax = (x < 0) ? -(ull) x: (ull) x;
+	ay = (y < 0) ? -(ull) y: (ull) y;
+
+	/* Fold into the first octant */
+	if ((swap = ay > ax)) {
+		t = ax;
+		ax = ay;
+		ay = t;
+	}
+	if (ax == 0)
+		return CONST_0;
+
+	/* Scale so that 2^60 <= ax < 2^61 */
+	n = sllbitlen(ax) - 61;
+	if (n > 0) {
+		ax >>= n;
+		ay >>= n;
+	} else {
+		ax <<= -n;
+		ay <<= -n;
+	}
+
+	/* Vectoring mode */
+	xn = (sll) ax;
+	yn = (sll) ay;
+	z = CONST_0;
+	for (i = 0; i < SLLATAN2_STEPS; i++) {
+		/* m = 0 rotates clockwise (y > 0), m = -1 counter-clockwise */
+		sll m = ~(_sllneg(yn) >> 63);
+		sll xs = xn >> i;
+		sll ys = yn >> i;
+
+		xn += (ys ^ m) - m;
+		yn -= (xs ^ m) - m;
+		z += (_sllatan2_tab[i] ^ m) - m;
+	}
+
+	/* Remaining angle, y / x at 2^-45, 2^60 <= x < 2^63 and |y| < x * 2^-16 */
+	z += _sllmul2n(_sllmul2n(yn, 16) / _slldiv2n(xn, 29), 16);
+
+	/* Unfold the octant */
+	if (swap)
+		z = SLLATAN2_PI_2 - z;
+	if (x < 0)
+		z = SLLATAN2_PI - z;
+
+	/* Round to 32.32 */
+	z = (z + 0x10000000LL) >> 29;
+
+	return ((y < 0) ? _sllneg(z): z);
+}
+
+/*
+ * Calculate atan x
+ *
+ * Description
+ *
+ *	atan x = atan2 (x, 1)
+ *
+ *	Out-of-range arguments need no inversion, the CORDIC core handles any
+ *	ratio directly.
+ */
+
+sll sllatan(sll x)
+{
+	return sllatan2(x, CONST_1);
+}
+
+/*
+ * Calculate 2^x where -0.5 <= x <= 0.5
+ *
+ * Description
+ *
+ *	2^x = e^(x * ln 2) = SUM[n=0,) (ln 2)^n * x^n / n!
+ *
+ *	|x * ln 2| <= 0.347, and 0.347^10 / 10! < 2^-37, so the series stops
+ *	after the x^9 term.  Evaluated by Horner's rule, 9 multiplies.
+ */
+
+static const sll _sllexp2_tab[10] = {
+	0x0000000100000000LL,	// ln(2)^0 / 0!
+	0x00000000b17217f8LL,	// ln(2)^1 / 1!
+	0x000000003d7f7bffLL,	// ln(2)^2 / 2!
+	0x000000000e35846cLL,	// ln(2)^3 / 3!
+	0x000000000276556eLL,	// ln(2)^4 / 4!
+	0x0000000000576200LL,	// ln(2)^5 / 5!
+	0x00000000000a1849LL,	// ln(2)^6 / 6!
+	0x000000000000ffe6LL,	// ln(2)^7 / 7!
+	0x000000000000162cLL,	// ln(2)^8 / 8!
+	0x00000000000001b5LL,	// ln(2)^9 / 9!
+};
+
+sll _sllexp2(sll x)
+{
+	sll retval;
+	int i;
+
+	retval = _sllexp2_tab[9];
+	for (i = 8; i >= 0; i--)
+		retval = _slladd(_sllexp2_tab[i], sllmul(retval, x));
+
+	return retval;
+}
+
+/*
+ * Calculate 2^x for any value of x
  *
  * Description
  *
- *	atan x = SUM[n=0,) (-1)^n * x^(2  * n + 1) / (2 * n + 1), |x| <= 1
+ *	2^x = 2^i * 2^f, where i is the nearest integer and -0.5 <= f < 0.5
  *
- *	Using a two term approximation:
- * [1]	a = x - x^3 / 3
+ *	Since sll is binary, 2^i is a shift.  Right shifts round to nearest.
+ *	Results too large for sll saturate to CONST_MAX, results below half
+ *	an ulp to 0; x is clamped first, so that x + 0.5 cannot overflow.
+ */
+
+sll sllexp2(sll x)
+{
+	int i;
+	sll retval;
+
+	if (x >= _int2sll(32))
+		return CONST_MAX;
+	if (x <= -_int2sll(35))
+		return CONST_0;
+
+	/* x + 0.5 = i + frac, so x - i = frac - 0.5 */
+	x = _slladd(x, CONST_1_2);
+	i = _sll2int(x);
+	retval = _sllexp2(_sllsub(_sllfrac(x), CONST_1_2));
+
+	if (i >= 0) {
+		if (i > 31 || retval > (CONST_MAX >> i))
+			return CONST_MAX;
+		return _sllmul2n(retval, i);
+	}
+
+	i = -i;
+	if (i > 34)
+		return CONST_0;
+
+	return _slldiv2n(_slladd(retval, _sllmul2n((sll) 1, i - 1)), i);
+}
+
+/*
+ * Calculate e^x for any value of x
  *
- *	Results in:
- * 	atan x = a + D
- *	where D is the difference from the exact result
+ * Description
  *
- *	Letting D = atan d results in:
- * [2]	atan x = a + atan d
+ *	e^x = 2^(x * log2 e)
  *
- *	Re-arranging:
- *	atan x - a = atan d
+ *	log2 e is applied with 32 extra bits (CONST_LOG2_E_LO), so the only
+ *	error in the exponent is the final chop.
  *
- *	Applying tan to both sides:
- *	tan (atan x - a) = tan atan d
- *	tan (atan x - a) = d
- * 	d = tan (atan x - a)
+ *	x is clamped before the multiply, which would wrap beyond |x| = 1.49e9:
+ *	e^22 > CONST_MAX saturates, and e^-25 is below half an ulp.
+ */
+
+sll sllexp(sll x)
+{
+	if (x >= _int2sll(22))
+		return CONST_MAX;
+	if (x <= -_int2sll(25))
+		return CONST_0;
+
+	return sllexp2(_slladd(sllmul(x, CONST_LOG2_E),
+		_slldiv2n(sllmul(x, CONST_LOG2_E_LO), 32)));
+}
+
+/*
+ * Split x > 0 for the logarithms, returns ln (1 + u)
  *
- *	Applying the standard identity:
- *	tan (u - v) = (tan u - tan v) / (1 + tan u * tan v)
+ * Description
  *
- *	Results in:
- *	d = tan (atan x - a) = (tan atan x - tan a) / (1 + tan atan x * tan a)
- * 	d = tan (atan x - a) = (x - tan a) / (1 + x * tan a)
+ *	x = 2^k * c_j * (1 + u)
  *
- *	Let:
- * [3]	t = tan a
+ *	Where:
  *
- *	Results in:
- * [4]	d = (x - t) / (1 + x * t)
+ *	2^k comes from a bit scan, so that 1 <= m = x / 2^k < 2
+ *	c_j = 1 + j / 16 from the top 4 fraction bits of m
+ *	0 <= u = m / c_j - 1 < 1 / 16
  *
- *	So putting the pieces together:
- * [1]	a = x - x^3 / 3
- * [3]	t = tan a
- * [4]	d = (x - t) / (1 + x * t)
- * [2]	atan x = a + atan d
- * 	atan x = a + atan ((x - t) / (1 + x * t))
+ *	ln (1 + u) = u - u^2 / 2 + u^3 / 3 - ... + u^7 / 7
+ *	(1 / 16)^8 / 8 < 2^-35
  *
- *	The worst case is x = 1.0 which converges after 2 iterations.
+ *	Powers of two have u = 0, so their logarithms are exact.
  */
 
-sll sllatan(sll x)
+static const sll _slllog_tab[16][3] = {
+	/* 1 / c_j, ln c_j, log2 c_j */
+	{ 0x0000000100000000LL, 0x0000000000000000LL, 0x0000000000000000LL },	// 1 + 0 / 16
+	{ 0x00000000f0f0f0f1LL, 0x000000000f851860LL, 0x000000001663f6fbLL },	// 1 + 1 / 16
+	{ 0x00000000e38e38e4LL, 0x000000001e27076eLL, 0x000000002b803474LL },	// 1 + 2 / 16
+	{ 0x00000000d79435e5LL, 0x000000002bfe60e1LL, 0x000000003f782d72LL },	// 1 + 3 / 16
+	{ 0x00000000cccccccdLL, 0x00000000391fef8fLL, 0x000000005269e12fLL },	// 1 + 4 / 16
+	{ 0x00000000c30c30c3LL, 0x00000000459d72afLL, 0x00000000646eea24LL },	// 1 + 5 / 16
+	{ 0x00000000ba2e8ba3LL, 0x0000000051862f08LL, 0x00000000759d4f81LL },	// 1 + 6 / 16
+	{ 0x00000000b21642c8LL, 0x000000005ce75fdbLL, 0x0000000086082807LL },	// 1 + 7 / 16
+	{ 0x00000000aaaaaaabLL, 0x0000000067cc8fb3LL, 0x0000000095c01a3aLL },	// 1 + 8 / 16
+	{ 0x00000000a3d70a3dLL, 0x00000000723fdf1eLL, 0x00000000a4d3c25eLL },	// 1 + 9 / 16
+	{ 0x000000009d89d89eLL, 0x000000007c4a3d7fLL, 0x00000000b3500472LL },	// 1 + 10 / 16
+	{ 0x0000000097b425edLL, 0x0000000085f39721LL, 0x00000000c1404eaeLL },	// 1 + 11 / 16
+	{ 0x0000000092492492LL, 0x000000008f42faf4LL, 0x00000000ceaecfebLL },	// 1 + 12 / 16
+	{ 0x000000008d3dcb09LL, 0x00000000983eb99aLL, 0x00000000dba4a47bLL },	// 1 + 13 / 16
+	{ 0x0000000088888889LL, 0x00000000a0ec7f42LL, 0x00000000e829fb69LL },	// 1 + 14 / 16
+	{ 0x0000000084210842LL, 0x00000000a9516933LL, 0x00000000f446359bLL },	// 1 + 15 / 16
+};
+
+sll _slllog(sll x, int *k, int *j)
 {
-	int side;
-	sll a;
-	sll t;
-	sll retval;
-
-
-	if (x < CONST_1) {
-
-		/* Left:  if (x < -1) then atan x = pi / 2 + atan 1 / x */
-		side = -1;
-		x = sllinv(x);
-
-	} else if (x > CONST_1) {
+	sll u;
 
-		/* Right:  if (x > 1) then atan x = pi / 2 - atan 1 / x */
-		side = 1;
-		x = sllinv(x);
+	/* Scale: 1 <= x < 2 */
+	*k = sllbitlen(x) - 33;
+	x = (*k > 0) ? _slldiv2n(x, *k): _sllmul2n(x, -*k);
 
-	} else {
-		/* Middle:  -1 <= x <= 1 */
-		side = 0;
-	}
+	*j = (int) ((x >> 28) & 15);
+	u = _sllsub(sllmul(x, _slllog_tab[*j][0]), CONST_1);
 
-	/* Initial approximate */
-	a = sllmul(x, _sllsub(CONST_1, sllmul(x, sllmul(x, CONST_1_3))));
-	retval = a;
+	x = _sllsub(CONST_1_6, sllmul(u, CONST_1_7));
+	x = _sllsub(CONST_1_5, sllmul(u, x));
+	x = _sllsub(CONST_1_4, sllmul(u, x));
+	x = _sllsub(CONST_1_3, sllmul(u, x));
+	x = _sllsub(CONST_1_2, sllmul(u, x));
+	x = _sllsub(CONST_1, sllmul(u, x));
 
-	/* First iteration */
-	t = _slldiv(_sllsin(a), _sllcos(a));
-	x = _slldiv(_sllsub(x, t), _slladd(CONST_1, sllmul(x, t)));
-	a = sllmul(x, _sllsub(CONST_1, sllmul(x, sllmul(x, CONST_1_3))));
-	retval = _slladd(retval, a);
+	return sllmul(u, x);
+}
 
-	/* Second iteration */
-	t = _slldiv(_sllsin(a), _sllcos(a));
-	x = _slldiv(_sllsub(x, t), _slladd(CONST_1, sllmul(x, t)));
-	a = sllmul(x, _sllsub(CONST_1, sllmul(x, sllmul(x, CONST_1_3))));
-	retval =  _slladd(retval, a);
+/*
+ * Calculate natural logarithm
+ *
+ * Description
+ *
+ *	ln x = k * ln 2 + ln c_j + ln (1 + u), see _slllog()
+ *
+ *	k * ln 2 is formed from ln 2 at 2^-56, so it adds no more than half an
+ *	ulp for any k.
+ *
+ *	x <= 0 returns CONST_MIN.
+ */
 
-	if (side == -1) {
+sll slllog(sll x)
+{
+	int k;
+	int j;
+	sll ln;
 
-		/* Left:  if (x < -1) then atan x = pi / 2 + atan 1 / x */
-		retval = _slladd(CONST_PI_2, retval);
+	if (x <= CONST_0)
+		return CONST_MIN;
 
-	} else if (side == 1) {
+	ln = _slladd(_slllog(x, &k, &j), _slllog_tab[j][1]);
 
-		/* Right:  if (x > 1) then atan x = pi / 2 - atan 1 / x */
-		retval = _sllsub(CONST_PI_2, retval);
-	}
+	/* k * ln 2 */
+	x = (sll) (((ull) ((k < 0) ? -k: k) * CONST_LN2_56 + 0x800000ULL) >> 24);
 
-	return retval;
+	return ((k < 0) ? _sllsub(ln, x): _slladd(ln, x));
 }
 
 /*
- * Calculate e^x where -0.5 <= x <= 0.5
+ * Calculate base 2 logarithm
+ *
+ * Description
+ *
+ *	log2 x = k + log2 c_j + ln (1 + u) * log2 e, see _slllog()
  *
- * Description:
- *	e^x = x^0 / 0! + x^1 / 1! + ... + x^N / N!
- *	Note that 0.5^11 / 11! < 2^-32 which is the smallest possible number.
+ *	x <= 0 returns CONST_MIN.
  */
 
-sll _sllexp(sll x)
+sll slllog2(sll x)
 {
-	sll retval;
+	int k;
+	int j;
 
-	retval = CONST_1;
+	if (x <= CONST_0)
+		return CONST_MIN;
 
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_11)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_10)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_9)));
-	retval = _slladd(CONST_1, sllmul(retval, slldiv2n(x, 3)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_7)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_6)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_5)));
-	retval = _slladd(CONST_1, sllmul(retval, slldiv4(x)));
-	retval = _slladd(CONST_1, sllmul(retval, sllmul(x, CONST_1_3)));
-	retval = _slladd(CONST_1, sllmul(retval, slldiv2(x)));
-	retval = _slladd(CONST_1, sllmul(retval, x));
+	x = sllmul(_slllog(x, &k, &j), CONST_LOG2_E);
 
-	return retval;
+	return _slladd(_slladd(_int2sll(k), _slllog_tab[j][2]), x);
 }
 
 /*
- * Calculate e^x for any value of x
+ * Divide two sll values, exactly
+ *
+ * Description
+ *
+ *	x / y = (x * 2^32) / y
+ *
+ *	Computed from the magnitudes as a 96 by 64 bit unsigned integer divide,
+ *	the quotient is exact and truncated toward zero.  Where the compiler
+ *	has no 128 bit integer type, a restoring long division gives the very
+ *	same bits, one quotient bit per step.
+ *
+ *	Unlike the rest of the library, the result is defined everywhere:
+ *	a quotient that does not fit, including y = 0, saturates to CONST_MAX
+ *	or CONST_MIN, rather than trapping.
+ *
+ *	sllqdiv() is the same for any format with 0 <= f <= 63 fractional bits,
+ *	x / y = (x * 2^f) / y.
  */
 
-sll sllexp(sll x)
+sll slldiv_exact(sll x, sll y)
 {
-	int i;
-	sll e;
-	sll retval;
+	return sllqdiv(x, y, 32);
+}
 
-	e = CONST_E;
+sll sllqdiv(sll x, sll y, int f)
+{
+	int sgn;
+	ull n;
+	ull d;
+	ull q;
 
-	/* -0.5 <= x <= 0.5  */
-	i = _sll2int(_slladd(x, CONST_1_2));
-	retval = _sllexp(_sllsub(x, _int2sll(i)));
+	if (x == CONST_0)
+		return CONST_0;
 
-	/* i >= 0 */
-	if (i < 0) {
-		i = -i;
-		e = CONST_1_E;
-	}
+	sgn = (x < 0) != (y < 0);
+	n = (x < 0) ? -(ull) x: (ull) x;
+	d = (y < 0) ? -(ull) y: (ull) y;
 
-	/* Scale the result */
-	for (; i; i >>= 1) {
-		if (i & 1)
-			retval = sllmul(retval, e);
-		e = sllmul(e, e);
+	/* n * 2^f / d >= 2^63 */
+	if ((n >> (63 - f)) >= d)
+		return ((sgn) ? CONST_MIN: CONST_MAX);
+
+#if defined(SLL_HAS_INT128)
+
+	q = (ull) (((ull128) n << f) / d);
+
+#else /* !defined(SLL_HAS_INT128) */
+	{
+		ull hi;
+		ull carry;
+		int i;
+
+		/* hi:q = n * 2^f, and hi < d since the quotient fits */
+		hi = (f > 0) ? n >> (64 - f): 0;
+		q = n << f;
+		for (i = 0; i < 64; i++) {
+			carry = hi >> 63;
+			hi = (hi << 1) | (q >> 63);
+			q <<= 1;
+			if (carry || hi >= d) {
+				hi -= d;
+				q |= 1;
+			}
+		}
 	}
+#endif /* defined(SLL_HAS_INT128) */
 
-	return retval;
+	return ((sgn) ? _sllneg((sll) q): (sll) q);
 }
 
 /*
- * Calculate natural logarithm using Netwton-Raphson method
+ * Calculate the inverse, exactly
+ *
+ * Description
+ *
+ *	1 / x = 2^64 / x, see slldiv_exact()
  */
 
-sll slllog(sll x)
+sll sllinv_exact(sll x)
 {
-	sll x1;
-	sll ln;
-
-	ln = 0;
-
-	/* Scale: e^(-1/2) <= x <= e^(1/2) */
-	while (x < CONST_1_SQRTE) {
-		ln = _sllsub(ln, CONST_1);
-		x = sllmul(x, CONST_E);
-	}
-	while (x > CONST_SQRTE) {
-		ln = _slladd(ln, CONST_1);
-		x = sllmul(x, CONST_1_E);
-	}
-
-	/* First iteration */
-	x1 = sllmul(_sllsub(x, CONST_1), slldiv2(_sllsub(x, CONST_3)));
-	ln = _sllsub(ln, x1);
-	x = sllmul(x, _sllexp(x1));
-
-	/* Second iteration */
-	x1 = sllmul(_sllsub(x, CONST_1), slldiv2(_sllsub(x, CONST_3)));
-	ln = _sllsub(ln, x1);
-	x = sllmul(x, _sllexp(x1));
-
-	/* Third iteration */
-	x1 = sllmul(_sllsub(x, CONST_1), slldiv2(_sllsub(x, CONST_3)));
-	ln = _sllsub(ln, x1);
-
-	return ln;
+	return slldiv_exact(CONST_1, x);
 }
 
 /*
@@ -735,6 +2125,12 @@ sll slllog(sll x)
 
 sll sllinv(sll x)
 {
+#if defined(SLL_DIV_HARDWARE)
+
+	return sllinv_exact(x);
+
+#else /* !defined(SLL_DIV_HARDWARE) */
+
 	int sgn;
 	sll u;
 	ull s;
@@ -751,8 +2147,8 @@ sll sllinv(sll x)
 	s = -1;
 
 	/* An approximation - must be larger than the actual value */
-	for (u = x; u; u = ((ull) u) >> 1)
-		s >>= 1;
+	u = sllbitlen(x);
+	s = (u < 64) ? s >> u: 0;
 
 	/* Newton's Method */
 	u = sllmul(s, _sllsub(CONST_2, sllmul(x, s)));
@@ -763,6 +2159,8 @@ sll sllinv(sll x)
 	u = sllmul(u, _sllsub(CONST_2, sllmul(x, u)));
 
 	return ((sgn) ? _sllneg(u): u);
+
+#endif /* defined(SLL_DIV_HARDWARE) */
 }
 
 /*
@@ -771,25 +2169,86 @@ sll sllinv(sll x)
  * Description
  *
  *	The standard identity:
- *	ln x^y = y * log x
+ *	log2 x^y = y * log2 x
  *
- *	Raising e to the power of either sides:
- *	e^(ln x^y) = e^(y * log x)
+ *	Raising 2 to the power of either sides:
+ *	2^(log2 x^y) = 2^(y * log2 x)
  *
  *	Which simplifies to:
- *	x^y = e^(y * ln x)
+ *	x^y = 2^(y * log2 x)
+ *
+ *	Whole exponents go through sllpowi(), which is faster, keeps full
+ *	precision and handles negative bases.
  */
 
 sll sllpow(sll x, sll y)
 {
-	if (y == CONST_0)
-		return CONST_1;
-	if (y == CONST_1)
-		return x;
-	if (y == CONST_2)
-		return sllmul(x, x);
+	if ((y & 0xffffffffLL) == 0)
+		return sllpowi(x, _sll2int(y));
 	
-	return sllexp(sllmul(y, slllog(x)));
+	return sllexp2(sllmul(y, slllog2(x)));
+}
+
+/*
+ * Calculate x^n for a whole n
+ *
+ * Description
+ *
+ *	Exponentiation by squaring, at most 2 * 31 multiplies:
+ *	x^n = (x^2)^(n / 2) * x^(n % 2)
+ *
+ *	The magnitude is raised and the sign applied last, so that overflow
+ *	can be detected exactly: once a partial product reaches 2^31 the result
+ *	saturates to CONST_MAX (or -CONST_MAX for an odd power of a negative
+ *	x).
+ *
+ *	For |x| >= 1, x^-n = 1 / x^n.  If x^n rounds to zero, x^-n saturates.
+ *	For |x| < 1, x^n would keep few significant bits, so x is inverted
+ *	first, exactly: x^-n = (1 / x)^n.
+ */
+
+static sll _sllpowi(ull x, unsigned int n)
+{
+	sll retval;
+
+	retval = CONST_1;
+	for (;;) {
+		if (n & 1) {
+			if (sllbitlen(retval) + sllbitlen(x) > 96)
+				return CONST_MAX;
+			retval = sllmul(retval, x);
+			if (retval < CONST_0)
+				return CONST_MAX;
+		}
+		n >>= 1;
+		if (n == 0)
+			return retval;
+		if (sllbitlen(x) > 48)
+			return CONST_MAX;
+		x = sllmul(x, x);
+		if ((sll) x < CONST_0)
+			return CONST_MAX;
+	}
+}
+
+sll sllpowi(sll x, int n)
+{
+	unsigned int u;
+	ull ax;
+	sll retval;
+
+	u = (n < 0) ? 0u - (unsigned int) n: (unsigned int) n;
+	ax = (x < CONST_0) ? 0 - (ull) x: (ull) x;
+
+	if (n < 0 && ax < (ull) CONST_1) {
+		retval = _sllpowi((ull) sllinv_exact((sll) ax), u);
+	} else {
+		retval = _sllpowi(ax, u);
+		if (n < 0)
+			retval = (retval == CONST_0) ? CONST_MAX: sllinv(retval);
+	}
+
+	return ((x < CONST_0) && (u & 1)) ? _sllneg(retval): retval;
 }
 
 /*
@@ -844,6 +2303,8 @@ sll sllpow(sll x, sll y)
 
 sll sllsqrt(sll x)
 {
+	int b;
+	int k;
 	sll n;
 	sll xn;
        
@@ -851,17 +2312,23 @@ sll sllsqrt(sll x)
 	if (x <= CONST_0 || x == CONST_1)
 		return x;
 
-	/* Start with a scaling factor of 1 */
-	n = CONST_1;
-
-	/* Scale x so that 0.5 <= x < 2 */
-	while (x >= CONST_2) {
-		x = slldiv4(x);
-		n = sllmul2(n);
-	}
-	while (x < CONST_1_2) {
-		x = sllmul4(x);
-		n = slldiv2(n);
+	/*
+	 * Scale x so that 0.5 <= x < 2, and start with a scaling factor of 1
+	 *
+	 * x >= 2 has at least 34 significant bits, each 4^k step removes two,
+	 * and x < 0.5 has at most 31.  Same result as shifting by 2 in a loop.
+	 */
+	b = sllbitlen(x);
+	if (b > 33) {
+		k = (b - 32) >> 1;
+		x = _slldiv2n(x, 2 * k);
+		n = _sllmul2n(CONST_1, k);
+	} else if (b < 32) {
+		k = (33 - b) >> 1;
+		x = _sllmul2n(x, 2 * k);
+		n = _slldiv2n(CONST_1, k);
+	} else {
+		n = CONST_1;
 	}
 
 	/* Simple solution if x = 4^n */
@@ -881,6 +2348,76 @@ sll sllsqrt(sll x)
 	return sllmul(n, xn);
 }
 
+/*
+ * Calculate the reciprocal square-root
+ *
+ * Description
+ *
+ *	x^(-1 / 2) = 2^-k * m^(-1 / 2), where x = 4^k * m and 1 <= m < 4
+ *
+ *	The seed comes from the top bits of m, and is within 3% of the root
+ *	over each interval.  Newton-Raphson for f(y) = 1 / y^2 - m gives:
+ *	y[n+1] = y[n] + y[n] * (1 - m * y[n]^2) / 2
+ *
+ *	Which has no division, and squares the error each step:
+ *	3% -> 0.14% -> 3e-6 -> 1e-11.
+ *
+ *	x <= 0 returns 0.
+ */
+
+static const sll _sllrsqrt_tab[24] = {
+	0x00000000f89260a4LL,	// 8/8 <= m < 9/8
+	0x00000000eb15adb6LL,	// 9/8 <= m < 10/8
+	0x00000000df94fc4bLL,	// 10/8 <= m < 11/8
+	0x00000000d59eaa4eLL,	// 11/8 <= m < 12/8
+	0x00000000cce1cae2LL,	// 12/8 <= m < 13/8
+	0x00000000c522f3c0LL,	// 13/8 <= m < 14/8
+	0x00000000be356669LL,	// 14/8 <= m < 15/8
+	0x00000000b7f6b564LL,	// 15/8 <= m < 16/8
+	0x00000000b24be522LL,	// 16/8 <= m < 17/8
+	0x00000000ad1f7890LL,	// 17/8 <= m < 18/8
+	0x00000000a86014edLL,	// 18/8 <= m < 19/8
+	0x00000000a3ff897fLL,	// 19/8 <= m < 20/8
+	0x000000009ff21b05LL,	// 20/8 <= m < 21/8
+	0x000000009c2dfe02LL,	// 21/8 <= m < 22/8
+	0x0000000098aaf23bLL,	// 22/8 <= m < 23/8
+	0x000000009561f607LL,	// 23/8 <= m < 24/8
+	0x00000000924d0b0fLL,	// 24/8 <= m < 25/8
+	0x000000008f670803LL,	// 25/8 <= m < 26/8
+	0x000000008cab73ffLL,	// 26/8 <= m < 27/8
+	0x000000008a166961LL,	// 27/8 <= m < 28/8
+	0x0000000087a47e47LL,	// 28/8 <= m < 29/8
+	0x000000008552b180LL,	// 29/8 <= m < 30/8
+	0x00000000831e5af3LL,	// 30/8 <= m < 31/8
+	0x0000000081051ec8LL,	// 31/8 <= m < 32/8
+};
+
+sll sllrsqrt(sll x)
+{
+	int k;
+	sll m;
+	sll y;
+
+	if (x <= CONST_0)
+		return CONST_0;
+
+	/* Scale: 1 <= m < 4, k rounded down to even */
+	k = (sllbitlen(x) - 33) & ~1;
+	m = (k > 0) ? _slldiv2n(x, k): _sllmul2n(x, -k);
+	k >>= 1;
+
+	y = _sllrsqrt_tab[(m >> 29) - 8];
+	y = _slladd(y, _slldiv2(sllmul(y, _sllsub(CONST_1, sllmul(sllmul(m, y), y)))));
+	y = _slladd(y, _slldiv2(sllmul(y, _sllsub(CONST_1, sllmul(sllmul(m, y), y)))));
+	y = _slladd(y, _slldiv2(sllmul_rn(y, _sllsub(CONST_1, sllmul_rn(sllmul_rn(m, y), y)))));
+
+	/* Scale the result, rounding */
+	if (k > 0)
+		return _slldiv2n(_slladd(y, _sllmul2n((sll) 1, k - 1)), k);
+
+	return _sllmul2n(y, -k);
+}
+
 sll slld2dsqrt(sll num)
 {
 	if (num <= CONST_0 || num == CONST_1)
@@ -954,4 +2491,287 @@ sll slld2dsqrt(sll num)
 	}
 
 	return result;
-}
\ No newline at end of file
+}
+
+/*
+ * Magnitudes
+ *
+ * Description
+ *
+ *	The squares are summed exactly in 128 bits as 64.64, so nothing is
+ *	lost for small components and nothing overflows for large ones; adding
+ *	sllmul(x, x) terms overflows once a component passes 46341.
+ *
+ *	The square root of a 64.64 value N is isqrt(N) * 2^-32, which is
+ *	already the 32.32 result.  isqrt() scales N by 4^k into [2^124, 2^126)
+ *	and takes the 31 bit root s of the top 64 bits, from a seed within 6%
+ *	and three 64 bit Newton steps.  One more Newton step on the whole of
+ *	N, r = s * 2^32 + (N - s^2 * 2^64) / (s * 2^33), needs only a 64 bit
+ *	divide and is at most 2 too large; exact 128 bit squares correct it,
+ *	and the remainder rounds it to nearest: N - r^2 > r means
+ *	N > (r + 1/2)^2.  Roots of 2^63 and up saturate.
+ *
+ *	sllmagsq2() and sllmagsq3() chop the sum as slldot3() does, and
+ *	with sllmag2() and sllmag3() saturate to the largest sll instead of
+ *	wrapping.
+ *
+ *	The sllmagd*() and sllmagsqd*() distances take both ends of each
+ *	component, since a - b overflows sll once they are 2^31 apart.  Each
+ *	difference is formed as an unsigned magnitude, which always fits; one
+ *	of 2^63 or more already puts the result out of range.
+ */
+
+#define _SLL_MAX	((sll) 0x7fffffffffffffffLL)
+
+/*
+ * floor h^(1 / 2) for 2^60 <= h < 2^62
+ *
+ *	h^(1 / 2) <= (h + 2^61) / 2^31.5, by AM-GM, and is at most 6% less
+ *	over the range.  Each Newton step squares the error, and never goes
+ *	below floor h^(1 / 2), so three leave at most 1 to take off.
+ */
+
+static ull _sllisqrt64(ull h)
+{
+	ull s;
+
+	/* 0x5a82799a = 2^32 / 2^1.5, rounded up */
+	s = (((h >> 30) + ((ull) 1 << 31)) * 0x5a82799aULL) >> 32;
+	s = (s + h / s) >> 1;
+	s = (s + h / s) >> 1;
+	s = (s + h / s) >> 1;
+	while (s * s > h)
+		s--;
+	return s;
+}
+
+#if defined(SLL_HAS_INT128)
+
+static sll _sllisqrt(ull128 n)
+{
+	ull128 m;
+	ull h;
+	ull s;
+	ull r;
+	int k;
+
+	if (n == 0)
+		return CONST_0;
+	if (n >> 126)
+		return _SLL_MAX;
+
+	/* m = n * 4^k, 2^124 <= m < 2^126 */
+	k = (((ull) (n >> 64) != 0) ? 62 - sllbitlen((ull) (n >> 64)) :
+		126 - sllbitlen((ull) n)) >> 1;
+	m = n << (2 * k);
+
+	h = (ull) (m >> 64);
+	s = _sllisqrt64(h);
+	r = (s << 32) + ((((h - s * s) << 31) | ((ull) m >> 33)) / s);
+	while ((ull128) r * r > m)
+		r--;
+
+	r >>= k;
+	if (n - (ull128) r * r > r)
+		r++;
+	return (r > (ull) _SLL_MAX) ? _SLL_MAX : (sll) r;
+}
+
+static sll _sllsqchop(ull128 n)
+{
+	n = (n + _SLL_CHOP_BIAS) >> 32;
+	return (n > (ull128) _SLL_MAX) ? _SLL_MAX : (sll) n;
+}
+
+#define _SLLSQ(x)	((ull128) ((sll128) (x) * (x)))
+#define _SLLSQ_ADD(a, b)	((a) + (b))
+
+#else /* !defined(SLL_HAS_INT128) */
+
+static sll _sllisqrt(_sllwide n)
+{
+	_sllwide m;
+	_sllwide t;
+	ull h;
+	ull s;
+	ull r;
+	int k;
+
+	if (n.hi == 0 && n.lo == 0)
+		return CONST_0;
+	if (n.hi >> 62)
+		return _SLL_MAX;
+
+	/* m = n * 4^k, 2^124 <= m < 2^126 */
+	k = ((n.hi != 0) ? 62 - sllbitlen(n.hi) : 126 - sllbitlen(n.lo)) >> 1;
+	m = n;
+	if (2 * k >= 64) {
+		m.hi = m.lo << (2 * k - 64);
+		m.lo = 0;
+	} else if (k > 0) {
+		m.hi = (m.hi << (2 * k)) | (m.lo >> (64 - 2 * k));
+		m.lo <<= 2 * k;
+	}
+
+	h = m.hi;
+	s = _sllisqrt64(h);
+	r = (s << 32) + ((((h - s * s) << 31) | (m.lo >> 33)) / s);
+	while (!_sllwide_ge(m, _sllwide_umul(r, r)))
+		r--;
+
+	r >>= k;
+	t = _sllwide_sub(n, _sllwide_umul(r, r));
+	if (t.hi != 0 || t.lo > r)
+		r++;
+	return (r > (ull) _SLL_MAX) ? _SLL_MAX : (sll) r;
+}
+
+static sll _sllsqchop(_sllwide n)
+{
+	_sllwide bias = {0, _SLL_CHOP_BIAS};
+
+	n = _sllwide_add(n, bias);
+	if (n.hi >> 31)
+		return _SLL_MAX;
+	return (sll) ((n.hi << 32) | (n.lo >> 32));
+}
+
+static _sllwide _sllsq(sll x)
+{
+	ull a = (x < 0) ? 0 - (ull) x : (ull) x;
+
+	return _sllwide_umul(a, a);
+}
+
+#define _SLLSQ(x)	_sllsq(x)
+#define _SLLSQ_ADD(a, b)	_sllwide_add((a), (b))
+
+#endif /* defined(SLL_HAS_INT128) */
+
+sll sllmag2(sll x, sll y)
+{
+	return _sllisqrt(_SLLSQ_ADD(_SLLSQ(x), _SLLSQ(y)));
+}
+
+sll sllmag3(sll x, sll y, sll z)
+{
+	return _sllisqrt(_SLLSQ_ADD(_SLLSQ_ADD(_SLLSQ(x), _SLLSQ(y)), _SLLSQ(z)));
+}
+
+sll sllmagsq2(sll x, sll y)
+{
+	return _sllsqchop(_SLLSQ_ADD(_SLLSQ(x), _SLLSQ(y)));
+}
+
+sll sllmagsq3(sll x, sll y, sll z)
+{
+	return _sllsqchop(_SLLSQ_ADD(_SLLSQ_ADD(_SLLSQ(x), _SLLSQ(y)), _SLLSQ(z)));
+}
+
+/* |a - b|, exact */
+static ull _sllabsdiff(sll a, sll b)
+{
+	return (a >= b) ? (ull) a - (ull) b : (ull) b - (ull) a;
+}
+
+sll sllmagd2(sll ax, sll bx, sll ay, sll by)
+{
+	ull dx = _sllabsdiff(ax, bx);
+	ull dy = _sllabsdiff(ay, by);
+
+	if ((dx | dy) >> 63)
+		return _SLL_MAX;
+	return _sllisqrt(_SLLSQ_ADD(_SLLSQ((sll) dx), _SLLSQ((sll) dy)));
+}
+
+sll sllmagd3(sll ax, sll bx, sll ay, sll by, sll az, sll bz)
+{
+	ull dx = _sllabsdiff(ax, bx);
+	ull dy = _sllabsdiff(ay, by);
+	ull dz = _sllabsdiff(az, bz);
+
+	if ((dx | dy | dz) >> 63)
+		return _SLL_MAX;
+	return _sllisqrt(_SLLSQ_ADD(_SLLSQ_ADD(_SLLSQ((sll) dx), _SLLSQ((sll) dy)),
+		_SLLSQ((sll) dz)));
+}
+
+sll sllmagsqd2(sll ax, sll bx, sll ay, sll by)
+{
+	ull dx = _sllabsdiff(ax, bx);
+	ull dy = _sllabsdiff(ay, by);
+
+	if ((dx | dy) >> 63)
+		return _SLL_MAX;
+	return _sllsqchop(_SLLSQ_ADD(_SLLSQ((sll) dx), _SLLSQ((sll) dy)));
+}
+
+sll sllmagsqd3(sll ax, sll bx, sll ay, sll by, sll az, sll bz)
+{
+	ull dx = _sllabsdiff(ax, bx);
+	ull dy = _sllabsdiff(ay, by);
+	ull dz = _sllabsdiff(az, bz);
+
+	if ((dx | dy | dz) >> 63)
+		return _SLL_MAX;
+	return _sllsqchop(_SLLSQ_ADD(_SLLSQ_ADD(_SLLSQ((sll) dx), _SLLSQ((sll) dy)),
+		_SLLSQ((sll) dz)));
+}
+
+/*
+ * Square root of a value with f fractional bits
+ *
+ * Description
+ *
+ *	The root of x * 2^-f is isqrt(x * 2^f) * 2^-f, formed exactly in 128
+ *	bits and rounded to nearest, for 0 <= f <= 63.  x <= 0 returns 0.
+ */
+
+sll sllqsqrt(sll x, int f)
+{
+#if defined(SLL_HAS_INT128)
+
+	if (x <= 0)
+		return CONST_0;
+	return _sllisqrt((ull128) x << f);
+
+#else /* !defined(SLL_HAS_INT128) */
+
+	_sllwide n;
+
+	if (x <= 0)
+		return CONST_0;
+	n.hi = (f > 0) ? (ull) x >> (64 - f): 0;
+	n.lo = (ull) x << f;
+	return _sllisqrt(n);
+
+#endif /* defined(SLL_HAS_INT128) */
+}
+
+/*
+ * Change the number of fractional bits
+ *
+ * Description
+ *
+ *	Moving x from "from" to "to" fractional bits, 0 <= from, to <= 63,
+ *	gains or drops from - to bits.  Gained bits are exact and saturate to
+ *	CONST_MAX or CONST_MIN on overflow; dropped bits round to nearest, ties
+ *	up, without overflow.
+ */
+
+sll sllqconv(sll x, int from, int to)
+{
+	int d;
+
+	if (to >= from) {
+		d = to - from;
+		if (x > (_SLL_MAX >> d))
+			return CONST_MAX;
+		if (x < ((sll) CONST_MIN >> d))
+			return CONST_MIN;
+		return (sll) ((ull) x << d);
+	}
+
+	d = from - to;
+	return (x >> d) + ((x >> (d - 1)) & 1);
+}
@@ -1,8 +1,5 @@
 #if !defined(MATH_SLL_H)
 #  define MATH_SLL_H
-#include "lua.h"
-#include "lualib.h"
-#include "lauxlib.h"
 
 /*
  * Revision v1.24
@@ -23,7 +20,7 @@
  *	As some processors lack division instructions but have multiplication
  *	instructions, multiplication is favored over division.  This can be a
  *	penalty when used on a processor with a division instruction, so it is
- *	recommended to modify the division functions and macros in that case.
+ *	recommended to define SLL_DIV_HARDWARE in that case (see below).
  *
  *	On procesors without multiplication instructions, other algorithms, for
  *	example CORDIC, are probably faster.
@@ -44,13 +41,60 @@
  *	No checking for divide by zero (error).
  *	No checking for overflow (error).
  *	No checking for underflow (warning).
- *	Chops, doesn't round.
+ *	Chops, doesn't round (see sllmul_rn and SLL_MUL_ROUND).
+ *
+ * Configuration
+ *
+ *	The following may be defined when compiling anything that includes
+ *	math-sll.h.  Every peer of a lockstep simulation must be built with the
+ *	same set.
+ *
+ *	SLL_TRIG_TABLE		sin, cos and tan use a 257 entry quarter-wave
+ *				table plus a short correction series, instead
+ *				of the full Taylor series.  Results stay
+ *				bit-exact across platforms, and the series
+ *				remains the reference mode when undefined.
+ *
+ *	SLL_DIV_HARDWARE	slldiv and sllinv return the exact quotient,
+ *				truncated toward zero, from a 128 by 64 bit
+ *				integer divide, instead of Newton's method.
+ *				__int128 is used where the compiler has it, and
+ *				a bit-exact long division elsewhere.
+ *
+ *	SLL_MUL_ROUND		sllmul rounds to nearest, like sllmul_rn,
+ *				instead of chopping.  Removes the downward
+ *				drift of long-running accumulations.
+ *
+ *	SLL_ASIN_ITERATIVE	asin and acos use the original series with two
+ *				sin/cos/sqrt correction steps, instead of the
+ *				polynomial and one reciprocal square root.
+ *
+ *	SLL_NO_SIMD		The *_array kernels stay scalar.  Otherwise they
+ *				use AVX2 when the CPU reports it at run time on
+ *				x86 (GCC and Clang), and NEON on AArch64.  Both
+ *				give the same bits as the scalar loop, so peers
+ *				need not agree on this one.
  *
  * Functions
  *
- *	sll dbl2sll(double d)			double to sll
+ *	sll dbl2sll(double d)			double to sll, saturating
  *	double sll2dbl(sll s)			sll to double
  *
+ *	void dbl2sll_array(const double *src, sll *dst, int n)
+ *	void sll2dbl_array(const sll *src, double *dst, int n)
+ *	void sll2flt_array(const sll *src, float *dst, int n)
+ *
+ *	int str2sll(const char *s, sll *out)	decimal string to sll, exact
+ *	int sll2str(sll x, int digits, char *buf)	sll to decimal string
+ *
+ *	void sllaxpy_array(const sll *x, sll a, sll *y, int n)	y += a * x
+ *	void slladd_array(const sll *x, sll *y, int n)		y += x
+ *	void sllscale_array(sll a, sll *y, int n)		y *= a
+ *	void sllmul_array(const sll *x, sll *y, int n)		y *= x
+ *	void slllerp_array(const sll *x, sll t, sll *y, int n)	y += (x - y) * t
+ *	void sllclamp_array(sll lo, sll hi, sll *y, int n)	y = clamp(y, lo, hi)
+ *	sll slldot_array(const sll *x, const sll *y, int n)	sum of x * y
+ *
  *	sll int2sll(int i)			integer to sll
  *	int sll2int(sll s)			sll to integer
  *
@@ -62,18 +106,27 @@
  *	sll sllsub(sll x, sll y)		x - y
  *
  *	sll sllmul(sll x, sll y)		x * y
+ *	sll sllmul_rn(sll x, sll y)		x * y, rounded to nearest
  *	sll sllmul2(sll x)			x * 2
  *	sll sllmul2n(sll x, int n)		x * 2^n, 0 <= n <= 31
  *	sll sllmul4(sll x)			x * 4
+ *	sll sllmuli(sll x, int n)		x * n, exact
+ *	sll sllmla(sll a, sll x, sll y)		a + x * y
+ *	sll slldot2(x0, y0, x1, y1)		x0 * y0 + x1 * y1, chopped once
+ *	sll slldot3(x0, y0, x1, y1, x2, y2)	x0 * y0 + x1 * y1 + x2 * y2, chopped once
+ *	sll slldot4(x0, y0, ..., x3, y3)	x0 * y0 + ... + x3 * y3, chopped once
+ *	sll sllqmul(sll x, sll y, int f)	x * y, with f fractional bits
  *
  *	sll slldiv(sll x, sll y)		x / y
  *	sll slldiv2(sll x)			x / 2
  *	sll slldiv2n(sll x, int n)		x / 2^n, 0 <= n <= 31
  *	sll slldiv4(sll x)			x / 4
+ *	sll slldivi(sll x, int n)		x / n, n != 0, truncated toward zero
  *
  *	sll sllcos(sll x)			cos x
  *	sll sllsin(sll x)			sin x
  *	sll slltan(sll x)			tan x
+ *	void sllsincos(sll x, sll *s, sll *c)	*s = sin x, *c = cos x
  *
  *	sll sllsec(sll x)			sec x = 1 / cos x
  *	sll sllcsc(sll x)			csc x = 1 / sin x
@@ -82,6 +135,7 @@
  *	sll sllacos(sll x)			acos x
  *	sll sllasin(sll x)			asin x
  *	sll sllatan(sll x)			atan x
+ *	sll sllatan2(sll y, sll x)		atan (y / x), by quadrant
  *
  *	sll sllcosh(sll x)			cosh x
  *	sll sllsinh(sll x)			sinh x
@@ -93,14 +147,34 @@
  *
  *	sll sllexp(sll x)			e^x
  *	sll slllog(sll x)			ln x
+ *	sll sllexp2(sll x)			2^x
+ *	sll slllog2(sll x)			log2 x
  *
  *	sll sllinv(sll v)			1 / x
+ *	sll sllinv_exact(sll x)			1 / x, exact quotient
+ *	sll slldiv_exact(sll x, sll y)		x / y, exact quotient
+ *	sll sllqdiv(sll x, sll y, int f)	x / y, exact, with f fractional bits
  *	sll sllpow(sll x, sll y)		x^y
+ *	sll sllpowi(sll x, int n)		x^n, whole n
  *	sll sllsqrt(sll x)			x^(1 / 2)
+ *	sll sllrsqrt(sll x)			x^(-1 / 2)
+ *	sll sllmag2(sll x, sll y)		(x^2 + y^2)^(1 / 2), saturating
+ *	sll sllmag3(sll x, sll y, sll z)	(x^2 + y^2 + z^2)^(1 / 2), saturating
+ *	sll sllmagsq2(sll x, sll y)		x^2 + y^2, saturating
+ *	sll sllmagsq3(sll x, sll y, sll z)	x^2 + y^2 + z^2, saturating
+ *	sll sllmagd2(ax, bx, ay, by)		sllmag2(ax - bx, ay - by), no overflow
+ *	sll sllmagd3(ax, bx, ..., az, bz)	sllmag3(ax - bx, ...), no overflow
+ *	sll sllmagsqd2(ax, bx, ay, by)		sllmagsq2(ax - bx, ay - by), no overflow
+ *	sll sllmagsqd3(ax, bx, ..., az, bz)	sllmagsq3(ax - bx, ...), no overflow
+ *	sll sllqsqrt(sll x, int f)		x^(1 / 2), with f fractional bits
+ *
+ *	sll sllqconv(sll x, int from, int to)	x from "from" to "to" fractional bits
  *
  *	sll sllfloor(sll x)			floor x
  *	sll sllceil(sll x)			ceiling x
  *
+ *	int sllbitlen(ull v)			number of significant bits
+ *
  * Macros
  *
  *	Use of the following macros is optional, but may be beneficial with
@@ -166,15 +240,10 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
-/* DEC SA-110 "StrongARM" (armv4l) architecture has a big-endian double */
-#if defined(__arm__)
-#  if (!defined(__BYTE_ORDER__) || (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__))
-#	define BROKEN_IEEE754_DOUBLE
-#  endif
-#endif
-
 #ifdef _MSC_VER
 # define __inline__ __inline
+# define __extension__
+# include <intrin.h>
 # ifndef _MSC_STDINT_H_
 typedef signed __int64       int64_t;
 typedef unsigned __int64     uint64_t;
@@ -187,6 +256,15 @@ typedef unsigned __int64     uint64_t;
 	#define __inline__ inline
 #endif
 #endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "lua.h"
+#include "lualib.h"
+#include "lauxlib.h"
+
 /*
  * Data types
  */
@@ -194,12 +272,33 @@ typedef unsigned __int64     uint64_t;
 __extension__ typedef int64_t sll;
 __extension__ typedef uint64_t ull;
 
+/* Longest sll2str() output: sign, 10 digits, point, 32 digits and NUL */
+#define SLL_STR_MAX	45
+
+#if defined(__SIZEOF_INT128__)
+#  define SLL_HAS_INT128
+__extension__ typedef __int128 sll128;
+__extension__ typedef unsigned __int128 ull128;
+#endif
+
 /*
  * Function prototypes
  */
 
 sll dbl2sll(double d);
 double sll2dbl(sll s);
+void dbl2sll_array(const double *src, sll *dst, int n);
+void sll2dbl_array(const sll *src, double *dst, int n);
+void sll2flt_array(const sll *src, float *dst, int n);
+int str2sll(const char *s, sll *out);
+int sll2str(sll x, int digits, char *buf);
+void sllaxpy_array(const sll *x, sll a, sll *y, int n);
+void slladd_array(const sll *x, sll *y, int n);
+void sllscale_array(sll a, sll *y, int n);
+void sllmul_array(const sll *x, sll *y, int n);
+void slllerp_array(const sll *x, sll t, sll *y, int n);
+void sllclamp_array(sll lo, sll hi, sll *y, int n);
+sll slldot_array(const sll *x, const sll *y, int n);
 
 static __inline__ sll int2sll(int i);
 static __inline__ int sll2int(sll s);
@@ -211,22 +310,32 @@ static __inline__ sll slladd(sll x, sll y);
 static __inline__ sll sllneg(sll s);
 static __inline__ sll sllsub(sll x, sll y);
 sll sllmul(sll x, sll y);
+sll sllmul_rn(sll x, sll y);
+sll sllmla(sll a, sll x, sll y);
+sll slldot2(sll x0, sll y0, sll x1, sll y1);
+sll slldot3(sll x0, sll y0, sll x1, sll y1, sll x2, sll y2);
+sll slldot4(sll x0, sll y0, sll x1, sll y1, sll x2, sll y2, sll x3, sll y3);
+sll sllqmul(sll x, sll y, int f);
 static __inline__ sll sllmul2(sll x);
 static __inline__ sll sllmul4(sll x);
 static __inline__ sll sllmul2n(sll x, int n);
+static __inline__ sll sllmuli(sll x, int n);
 
 static __inline__ sll slldiv(sll x, sll y);
 static __inline__ sll slldiv2(sll x);
 static __inline__ sll slldiv4(sll x);
 static __inline__ sll slldiv2n(sll x, int n);
+static __inline__ sll slldivi(sll x, int n);
 
 sll sllcos(sll x);
 sll sllsin(sll x);
 sll slltan(sll x);
+void sllsincos(sll x, sll *s, sll *c);
 
-static __inline__ sll sllacos(sll x);
+sll sllacos(sll x);
 sll sllasin(sll x);
 sll sllatan(sll x);
+sll sllatan2(sll y, sll x);
 
 static __inline__ sll sllsec(sll x);
 static __inline__ sll sllcsc(sll x);
@@ -242,14 +351,32 @@ static __inline__ sll sllcoth(sll x);
 
 sll sllexp(sll x);
 sll slllog(sll x);
+sll sllexp2(sll x);
+sll slllog2(sll x);
 
 sll sllpow(sll x, sll y);
+sll sllpowi(sll x, int n);
 sll sllinv(sll v);
+sll sllinv_exact(sll x);
+sll slldiv_exact(sll x, sll y);
+sll sllqdiv(sll x, sll y, int f);
 sll sllsqrt(sll x);
+sll sllrsqrt(sll x);
 sll slld2dsqrt(sll x);
+sll sllmag2(sll x, sll y);
+sll sllmag3(sll x, sll y, sll z);
+sll sllmagsq2(sll x, sll y);
+sll sllmagsq3(sll x, sll y, sll z);
+sll sllmagd2(sll ax, sll bx, sll ay, sll by);
+sll sllmagd3(sll ax, sll bx, sll ay, sll by, sll az, sll bz);
+sll sllmagsqd2(sll ax, sll bx, sll ay, sll by);
+sll sllmagsqd3(sll ax, sll bx, sll ay, sll by, sll az, sll bz);
+sll sllqsqrt(sll x, int f);
+sll sllqconv(sll x, int from, int to);
 
 static __inline__ sll sllfloor(sll x);
 static __inline__ sll sllceil(sll x);
+static __inline__ int sllbitlen(ull v);
 
 /*
  * Macros
@@ -271,7 +398,11 @@ static __inline__ sll sllceil(sll x);
 #define _sllmul4(X)	((X) << 2)
 #define _sllmul2n(X,N)	((X) << (N))
 
+#if defined(SLL_DIV_HARDWARE)
+#define _slldiv(X,Y)	slldiv_exact((X), (Y))
+#else
 #define _slldiv(X,Y)	sllmul((X), sllinv(Y))
+#endif /* defined(SLL_DIV_HARDWARE) */
 #define _slldiv2(X)	((X) >> 1)
 #define _slldiv4(X)	((X) >> 2)
 #define _slldiv2n(X,N)	((X) >> (N))
@@ -287,7 +418,6 @@ static __inline__ sll sllceil(sll x);
 #define CONST_3		0x0000000300000000LL	// 3.0
 #define CONST_4		0x0000000400000000LL	// 4.0
 #define CONST_10	0x0000000a00000000LL	// 10.0
-#define CONST_10	0x0000000a00000000LL	// 10.0
 #define CONST_1_2	0x0000000080000000LL	// 1.0 / 2.0
 #define CONST_1_3	0x0000000055555555LL	// 1.0 / 3.0
 #define CONST_1_4	0x0000000040000000LL	// 1.0 / 4.0
@@ -314,9 +444,11 @@ static __inline__ sll sllceil(sll x);
 #define CONST_1_E	0x000000005e2d58d8LL	// 1 / E
 #define CONST_SQRTE	0x00000001a61298e1LL	// sqrt(E)
 #define CONST_1_SQRTE	0x000000009b4597e3LL	// 1 / sqrt(E)
-#define CONST_LOG2_E	0x0000000171547652LL	// ln(E)
+#define CONST_LOG2_E	0x0000000171547652LL	// log2(E)
+#define CONST_LOG2_E_LO	0x00000000b82fe177LL	// log2(E) - CONST_LOG2_E, in 2^-64
 #define CONST_LOG10_E	0x000000006f2dec54LL	// log(E)
 #define CONST_LN2	0x00000000b17217f7LL	// ln(2)
+#define CONST_LN2_56	0x00b17217f7d1cf7aLL	// ln(2), 8.56 format
 #define CONST_LN10	0x000000024d763776LL	// ln(10)
 
 #define CONST_PI	0x00000003243f6a88LL	// PI
@@ -324,6 +456,7 @@ static __inline__ sll sllceil(sll x);
 #define CONST_PI_2	0x00000001921fb544LL	// PI / 2
 #define CONST_PI_4	0x00000000c90fdaa2LL	// PI / 4
 #define CONST_1_PI	0x00000000517cc1b7LL	// 1 / PI
+#define CONST_512_PI	0x000000a2f9836e4eLL	// 512 / PI
 #define CONST_2_PI	0x00000000a2f9836eLL	// 2 / PI
 #define CONST_180_PI  	0x000000394BB834C7LL	// 180 / PI 246083499207.51537232162612011973
 #define CONST_PI_180	0x000000000477d1a8LL	// PI / 180 74961320.580677883103327681382757
@@ -485,6 +618,20 @@ static __inline__ sll sllmul2n(sll x, int n)
 	return _sllmul2n(x, n);
 }
 
+/*
+ * Multiplication by integer
+ *
+ * Description
+ *
+ *	int2sll(n) has no fractional bits, so nothing is chopped and the raw
+ *	value times n is exactly sllmul(x, int2sll(n)), in either rounding mode.
+ */
+
+static __inline__ sll sllmuli(sll x, int n)
+{
+	return (sll) ((ull) x * (ull) (sll) n);
+}
+
 /*
  * Division
  */
@@ -522,20 +669,17 @@ static __inline__ sll slldiv2n(sll x, int n)
 }
 
 /*
- *
- * Calculate acos x, where |x| <= 1
+ * Division by integer
  *
  * Description
  *
- *	acos x = pi / 2 - asin x
- *	acos x = pi / 2 - SUM[n=0,) C(2 * n, n) * x^(2 * n + 1) / (4^n * (2 * n + 1)), |x| <= 1
- *
- *	where C(n, r) = nCr = n! / (r! * (n - r)!)
+ *	The raw value divided by n is the exact quotient truncated toward zero,
+ *	the same as slldiv(x, int2sll(n)) with SLL_DIV_HARDWARE.
  */
 
-static __inline__ sll sllacos(sll x)
+static __inline__ sll slldivi(sll x, int n)
 {
-	return _sllsub(CONST_PI_2, sllasin(x));
+	return (n == -1) ? (sll) (0 - (ull) x) : x / n;
 }
 
 /*
@@ -635,7 +779,7 @@ static __inline__ sll sllsinh(sll x)
 
 static __inline__ sll slltanh(sll x)
 {
-	register sll e2x;
+	sll e2x;
 
 	e2x = sllexp(_sllmul2(x));
 
@@ -698,7 +842,7 @@ static __inline__ sll sllcsch(sll x)
 
 static __inline__ sll sllcoth(sll x)
 {
-	register sll e2x;
+	sll e2x;
 
 	e2x = sllexp(sllmul2(x));
 
@@ -715,7 +859,7 @@ static __inline__ sll sllcoth(sll x)
 
 static __inline__ sll sllfloor(sll x)
 {
-	register sll retval;
+	sll retval;
 
 	retval = _sllint(x);
 
@@ -732,21 +876,84 @@ static __inline__ sll sllfloor(sll x)
 
 static __inline__ sll sllceil(sll x)
 {
-	register sll retval;
+	sll retval;
 
 	retval = _sllint(x);
 
 	return ((retval < x) ? _slladd(retval, CONST_1): retval);
 }
 
+/*
+ * Number of significant bits in v, 0 <= result <= 64
+ *
+ * Description
+ *
+ *	bitlen v = 64 - clz v
+ *
+ *	A single bit-scan instruction where the compiler exposes one, and a
+ *	six step binary search elsewhere.  Either way the cost is constant,
+ *	which is what lets range reductions scale by 2^n in one step
+ *	instead of looping one shift at a time.
+ */
+
+static __inline__ int sllbitlen(ull v)
+{
+#if defined(__GNUC__)
+
+	return ((v) ? 64 - __builtin_clzll(v): 0);
+
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+
+	unsigned long i;
+
+	return ((_BitScanReverse64(&i, v)) ? (int) i + 1: 0);
+
+#else /* portable */
+
+	int n = 0;
+
+	if (v >> 32) {
+		v >>= 32;
+		n += 32;
+	}
+	if (v >> 16) {
+		v >>= 16;
+		n += 16;
+	}
+	if (v >> 8) {
+		v >>= 8;
+		n += 8;
+	}
+	if (v >> 4) {
+		v >>= 4;
+		n += 4;
+	}
+	if (v >> 2) {
+		v >>= 2;
+		n += 2;
+	}
+	if (v >> 1) {
+		v >>= 1;
+		n += 1;
+	}
+
+	return n + (int) v;
+
+#endif /* portable */
+}
+
 #define sllabs(x) ((x) < 0 ? -(x) : (x))
 #define __VECTOR2_META__ "__VECTOR2_META__"
 #define __VECTOR3_META__ "__VECTOR3_META__"
 #define __ROT2_META__ "__ROT2_META__"
 #define __ROT4_META__ "__ROT4_META__"
 #define __METATABLE_NAME "__FIX_METATABLE__"
+#define __FIX_ARRAY_META__ "__FIX_ARRAY_META__"
+#define __VECTOR3_ARRAY_META__ "__VECTOR3_ARRAY_META__"
+#define __MATRIX3_META__ "__MATRIX3_META__"
+#define __MATRIX4_META__ "__MATRIX4_META__"
 
-static int _mul[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+static const int _mul[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
 
 typedef struct Vector2
 {
@@ -770,10 +977,53 @@ typedef struct Vector4
 	
 }Vector4;
 
+// 按行存, 作用在列向量上: p' = M * p
+typedef struct Matrix3
+{
+	sll m[3][3];
+}Matrix3;
+
+// 按行存, 最后一列是平移, TransformPoint 不做透视除法
+typedef struct Matrix4
+{
+	sll m[4][4];
+}Matrix4;
+
+// 定长的定点数数组, 数据紧跟在结构体后面, 和 userdata 一起分配
+typedef struct FixArray
+{
+	int n;
+	sll *v;
+}FixArray;
+
+// 按分量分开存的 Vector3 数组 (SoA), x/y/z 各是一条连续的 lane
+typedef struct FixVec3Array
+{
+	int n;
+	sll *x;
+	sll *y;
+	sll *z;
+}FixVec3Array;
+
+extern const luaL_Reg lua_fixmath_meta_methods[];
+extern const luaL_Reg lua_fixmath_modules[];
 void push_fix(lua_State *L, sll v);
+void push_fix_up(lua_State *L, sll v);
+sll fix_checkdecimal(lua_State *L, int idx, int len_idx);
+sll fix_checkstring(lua_State *L, int idx);
+int fix_optdigits(lua_State *L, int idx);
+int fix_format_tuple(char *buf, const sll *v, int n);
+int fix_tosll(lua_State *L, int idx, sll *out);
+int fix_toint(lua_State *L, int idx, int *n);
+#if LUA_VERSION_NUM >= 503
+LUALIB_API int luaopen_fixmath_raw(lua_State* L);
+#endif
 sll clamp_fix(sll a, sll b, sll c);
 // vec2
+extern const luaL_Reg lua_vec2_meta_methods[];
+extern const luaL_Reg lua_vec2_modules[];
 void push_Vector2(lua_State *L, sll x, sll y);
+void push_Vector2_up(lua_State *L, sll x, sll y);
 sll vec2_dot(Vector2 *a, Vector2 *b);
 sll vec2_magnitude(Vector2 *self);
 sll vec2_sqrmagnitude(Vector2 *self);
@@ -785,59 +1035,189 @@ sll vec2_cross(Vector2 *a, Vector2 *b);
 	ret.x = sllsub(a->x, b->x); \
 	ret.y = sllsub(a->y, b->y) \
 // vec3
+extern const luaL_Reg lua_vec3_meta_methods[];
+extern const luaL_Reg lua_vec3_modules[];
 void push_Vector3(lua_State *L, sll x, sll y, sll z);
+void push_Vector3_up(lua_State *L, sll x, sll y, sll z);
 sll vec3_dot(Vector3 *a, Vector3 *b);
 void vec3_cross(Vector3 * a, Vector3 *b, Vector3 *out);
 sll vec3_magnitude(Vector3* self);
 void vec3_set_normalize(Vector3 * self);
 void vec3_lerp(Vector3 *a, Vector3 *b, sll tt, Vector3 *out);
-// rot2
+// fix_array
+extern const luaL_Reg lua_fix_array_meta_methods[];
+extern const luaL_Reg lua_fix_array_modules[];
+FixArray *push_FixArray(lua_State *L, int n);
+FixArray *push_FixArray_up(lua_State *L, int n);
+// vec3_array
+extern const luaL_Reg lua_vec3_array_meta_methods[];
+extern const luaL_Reg lua_vec3_array_modules[];
+FixVec3Array *push_FixVec3Array(lua_State *L, int n);
+FixVec3Array *push_FixVec3Array_up(lua_State *L, int n);
+// rot2, 用 Vector2 存 (x = cos, y = sin)
+extern const luaL_Reg lua_rot2_meta_methods[];
+extern const luaL_Reg lua_rot2_modules[];
+void push_Rot2(lua_State *L, sll c, sll s);
+void push_Rot2_up(lua_State *L, sll c, sll s);
 void rot_mul_vec2(Vector2 *self, Vector2 *a, Vector2 *out);
+// rot4, 四元数, 用 Vector4 存 (x, y, z, w)
+extern const luaL_Reg lua_rot4_meta_methods[];
+extern const luaL_Reg lua_rot4_modules[];
+void push_Rot4(lua_State *L, sll x, sll y, sll z, sll w);
+void push_Rot4_up(lua_State *L, sll x, sll y, sll z, sll w);
+void rot4_mul(Vector4 *a, Vector4 *b, Vector4 *out);
+void rot4_mul_vec3(Vector4 *self, Vector3 *a, Vector3 *out);
+void rot4_set_normalize(Vector4 *self);
+// mat3
+extern const luaL_Reg lua_mat3_meta_methods[];
+extern const luaL_Reg lua_mat3_modules[];
+Matrix3 *push_Matrix3(lua_State *L);
+Matrix3 *push_Matrix3_up(lua_State *L);
+void mat3_mul(Matrix3 *a, Matrix3 *b, Matrix3 *out);
+void mat3_mul_vec3(Matrix3 *self, Vector3 *a, Vector3 *out);
+void mat3_from_rot4(Vector4 *q, Matrix3 *out);
+int mat3_inverse(Matrix3 *self, Matrix3 *out);
+// mat4
+extern const luaL_Reg lua_mat4_meta_methods[];
+extern const luaL_Reg lua_mat4_modules[];
+Matrix4 *push_Matrix4(lua_State *L);
+Matrix4 *push_Matrix4_up(lua_State *L);
+void mat4_mul(Matrix4 *a, Matrix4 *b, Matrix4 *out);
+void mat4_transform_point(Matrix4 *self, Vector3 *a, Vector3 *out);
+void mat4_transform_direction(Matrix4 *self, Vector3 *a, Vector3 *out);
+int mat4_inverse(Matrix4 *self, Matrix4 *out);
+// C++ 里会和 std::min/std::max 冲突, 只给 C 用
+#if !defined(__cplusplus)
+#ifndef max
 #define max(x, y) ((x) > (y) ? (x) : (y))
+#endif
+#ifndef min
 #define min(x, y) ((x) < (y) ? (x) : (y))
+#endif
+#endif
 
 #ifdef __MACH__
 #define luaL_testudata luaL_checkudata
 #endif
 
+// 元表缓存在 C 函数的 upvalue 里, 见 fix_push_metatables()
+// 所有注册给 Lua 的函数都带着这几个 upvalue, 按下标取元表不用查注册表
+enum
+{
+	FIX_META_FIX = 1,
+	FIX_META_VEC2,
+	FIX_META_VEC3,
+	FIX_META_FIX_ARRAY,
+	FIX_META_VEC3_ARRAY,
+	FIX_META_ROT2,
+	FIX_META_ROT4,
+	FIX_META_MAT3,
+	FIX_META_MAT4,
+	FIX_META_COUNT = FIX_META_MAT4
+};
+
+int fix_push_metatables(lua_State *L);
+
+// 压入缓存的元表, 只能在注册给 Lua 的函数(带着这些 upvalue 的 C 闭包)里调用
+// 5.1/LuaJIT/5.3 在 C 闭包以外取 upvalue 是未定义行为, 宿主 C 代码要用 push_* 而不是 push_*_up,
+// 它们按名字查注册表
+static __inline__ void fix_push_meta_up(lua_State *L, int slot)
+{
+	lua_pushvalue(L, lua_upvalueindex(slot));
+}
+
+// 同 luaL_testudata, 但元表按指针比较; 同样只能在注册给 Lua 的函数里调用
+static __inline__ void *fix_testudata(lua_State *L, int idx, int slot, const char *name)
+{
+	void *p = lua_touserdata(L, idx);
+	(void)name;
+	if (p == NULL || !lua_getmetatable(L, idx))
+		return NULL;
+	fix_push_meta_up(L, slot);
+	if (!lua_rawequal(L, -1, -2))
+		p = NULL;
+	lua_pop(L, 2);
+	return p;
+}
+
 #define check_set_fix(idx, var_name) \
-	sll* var_name = luaL_testudata(L, idx, __METATABLE_NAME); \
+	sll* var_name = fix_testudata(L, idx, FIX_META_FIX, __METATABLE_NAME); \
 	if(!var_name)\
 	{\
 		return luaL_error(L, "第%d个参数不是一个定点数", idx);\
 	}\
 
+// 同 check_set_fix, 但 var_name 是值, 也接受 Lua 整数和能精确表示的 Lua 浮点数
+#define check_get_fix(idx, var_name) \
+	sll var_name; \
+	if(!fix_tosll(L, idx, &var_name))\
+	{\
+		return luaL_error(L, "第%d个参数不是一个定点数", idx);\
+	}\
+
 #define test_set_fix(idx, var_name) \
-	sll* var_name = luaL_testudata(L, idx, __METATABLE_NAME); \
+	sll* var_name = fix_testudata(L, idx, FIX_META_FIX, __METATABLE_NAME); \
 
 #define check_set_vec2(idx, var_name) \
-	Vector2* var_name = luaL_testudata(L, idx, __VECTOR2_META__); \
+	Vector2* var_name = fix_testudata(L, idx, FIX_META_VEC2, __VECTOR2_META__); \
 	if(!var_name)\
 	{\
 		return luaL_error(L, "第%d个参数不是一个fix_vec2", idx);\
 	}\
 
 #define check_set_vec3(idx, var_name) \
-	Vector3* var_name = luaL_testudata(L, idx, __VECTOR3_META__); \
+	Vector3* var_name = fix_testudata(L, idx, FIX_META_VEC3, __VECTOR3_META__); \
 	if(!var_name)\
 	{\
 		return luaL_error(L, "第%d个参数不是一个fix_vec3", idx);\
 	}\
 
+#define check_set_fix_array(idx, var_name) \
+	FixArray* var_name = fix_testudata(L, idx, FIX_META_FIX_ARRAY, __FIX_ARRAY_META__); \
+	if(!var_name)\
+	{\
+		return luaL_error(L, "第%d个参数不是一个fix_array", idx);\
+	}\
+
+#define check_set_vec3_array(idx, var_name) \
+	FixVec3Array* var_name = fix_testudata(L, idx, FIX_META_VEC3_ARRAY, __VECTOR3_ARRAY_META__); \
+	if(!var_name)\
+	{\
+		return luaL_error(L, "第%d个参数不是一个fix_vec3_array", idx);\
+	}\
+
 #define check_set_rot2(idx, var_name) \
-	Vector2* var_name = luaL_testudata(L, idx, __ROT2_META__); \
+	Vector2* var_name = fix_testudata(L, idx, FIX_META_ROT2, __ROT2_META__); \
 	if(!var_name)\
 	{\
 		return luaL_error(L, "第%d个参数不是一个fix_rot2", idx);\
 	}\
 
+#define check_set_mat3(idx, var_name) \
+	Matrix3* var_name = fix_testudata(L, idx, FIX_META_MAT3, __MATRIX3_META__); \
+	if(!var_name)\
+	{\
+		return luaL_error(L, "第%d个参数不是一个fix_mat3", idx);\
+	}\
+
+#define check_set_mat4(idx, var_name) \
+	Matrix4* var_name = fix_testudata(L, idx, FIX_META_MAT4, __MATRIX4_META__); \
+	if(!var_name)\
+	{\
+		return luaL_error(L, "第%d个参数不是一个fix_mat4", idx);\
+	}\
+
 #define check_set_rot4(idx, var_name) \
-	Vector4* var_name = luaL_testudata(L, idx, __ROT4_META__); \
+	Vector4* var_name = fix_testudata(L, idx, FIX_META_ROT4, __ROT4_META__); \
 	if(!var_name)\
 	{\
 		return luaL_error(L, "第%d个参数不是一个fix_rot4", idx);\
 	}\
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* !defined(MATH_SLL_H) */
 
 #ifndef luaL_newlib /* using LuaJIT */
@@ -866,4 +1246,6 @@ LUALIB_API void luaL_setfuncs (lua_State *L, const luaL_Reg *l, int nup) {
   lua_createtable(L, 0, sizeof(l)/sizeof((l)[0]) - 1)
 
 #define luaL_newlib(L,l)  (luaL_newlibtable(L,l), luaL_setfuncs(L,l,0))
+
+#define lua_rawlen lua_objlen
 #endif
@@ -0,0 +1,201 @@
+#if !defined(MATH_SLL_HPP)
+#  define MATH_SLL_HPP
+
+#include <type_traits>
+
+#include "math-sll.h"
+
+/*
+ * fixmath::fix, a C++ value type over sll
+ *
+ * Description
+ *
+ *	fix holds one sll and nothing else.  Every operator is an inline call
+ *	to the math-sll function or macro of the same meaning, so code using fix
+ *	compiles to the same instructions as code calling sllmul() and friends
+ *	on sll directly.
+ *
+ *	Literals with the _fx suffix are converted while compiling, and exactly:
+ *	the decimal fraction is turned into binary digits by long multiplication
+ *	on the decimal string, never through a double, and rounded to nearest.
+ *	A literal that is malformed or does not fit in 32.32 fails to compile.
+ *
+ *		using namespace fixmath::literals;
+ *
+ *		fix a = 1.25_fx;
+ *		fix b = a * 3 + 0.1_fx;			// sllmuli(), slladd()
+ *		fix c = b * fixmath::pow2<4>();		// b << 4
+ *		fix d = b / fixmath::pow2<1>();		// b >> 1
+ *
+ *	Multiplication and division by pow2<N>() pick the shift at compile time,
+ *	0 <= N <= 31.  Division by pow2<N>() rounds toward minus infinity, as
+ *	slldiv2n() does.  Multiplication and division by int use sllmuli() and
+ *	slldivi().
+ *
+ *	Requires C++14.
+ */
+
+namespace fixmath {
+
+template <int N>
+struct pow2 {
+	static_assert(N >= 0 && N <= 31, "fixmath::pow2<N> needs 0 <= N <= 31");
+};
+
+class fix {
+public:
+	constexpr fix() : v(CONST_0) {}
+	constexpr explicit fix(int i) : v((sll) ((ull) (sll) i << 32)) {}
+
+	static constexpr fix from_raw(sll r) { return fix(r, 0); }
+	static fix from_double(double d) { return fix(dbl2sll(d), 0); }
+
+	constexpr sll raw() const { return v; }
+	constexpr int to_int() const { return _sll2int(v); }
+	double to_double() const { return sll2dbl(v); }
+
+	constexpr fix operator+() const { return *this; }
+	constexpr fix operator-() const { return fix(_sllneg(v), 0); }
+
+	constexpr fix &operator+=(fix b) { v = _slladd(v, b.v); return *this; }
+	constexpr fix &operator-=(fix b) { v = _sllsub(v, b.v); return *this; }
+	fix &operator*=(fix b) { v = sllmul(v, b.v); return *this; }
+	fix &operator/=(fix b) { v = slldiv(v, b.v); return *this; }
+	fix &operator*=(int n) { v = sllmuli(v, n); return *this; }
+	fix &operator/=(int n) { v = slldivi(v, n); return *this; }
+
+	/* Left shift through ull, a negative sll can't be shifted in a constant expression */
+	template <int N>
+	constexpr fix &operator*=(pow2<N>) { v = (sll) ((ull) v << N); return *this; }
+	template <int N>
+	constexpr fix &operator/=(pow2<N>) { v = _slldiv2n(v, N); return *this; }
+
+private:
+	sll v;
+
+	constexpr fix(sll r, int) : v(r) {}
+};
+
+static_assert(sizeof(fix) == sizeof(sll), "fix must be a bare sll");
+static_assert(std::is_trivially_copyable<fix>::value, "fix must copy like sll");
+
+constexpr fix operator+(fix a, fix b) { return a += b; }
+constexpr fix operator-(fix a, fix b) { return a -= b; }
+inline fix operator*(fix a, fix b) { return fix::from_raw(sllmul(a.raw(), b.raw())); }
+inline fix operator/(fix a, fix b) { return fix::from_raw(slldiv(a.raw(), b.raw())); }
+inline fix operator*(fix a, int n) { return fix::from_raw(sllmuli(a.raw(), n)); }
+inline fix operator*(int n, fix a) { return fix::from_raw(sllmuli(a.raw(), n)); }
+inline fix operator/(fix a, int n) { return fix::from_raw(slldivi(a.raw(), n)); }
+
+template <int N>
+constexpr fix operator*(fix a, pow2<N> p) { return a *= p; }
+template <int N>
+constexpr fix operator*(pow2<N> p, fix a) { return a *= p; }
+template <int N>
+constexpr fix operator/(fix a, pow2<N> p) { return a /= p; }
+
+constexpr bool operator==(fix a, fix b) { return a.raw() == b.raw(); }
+constexpr bool operator!=(fix a, fix b) { return a.raw() != b.raw(); }
+constexpr bool operator<(fix a, fix b) { return a.raw() < b.raw(); }
+constexpr bool operator<=(fix a, fix b) { return a.raw() <= b.raw(); }
+constexpr bool operator>(fix a, fix b) { return a.raw() > b.raw(); }
+constexpr bool operator>=(fix a, fix b) { return a.raw() >= b.raw(); }
+
+constexpr fix abs(fix a) { return (a.raw() < 0) ? -a : a; }
+constexpr fix min(fix a, fix b) { return (b < a) ? b : a; }
+constexpr fix max(fix a, fix b) { return (a < b) ? b : a; }
+
+inline fix floor(fix a) { return fix::from_raw(sllfloor(a.raw())); }
+inline fix ceil(fix a) { return fix::from_raw(sllceil(a.raw())); }
+inline fix inv(fix a) { return fix::from_raw(sllinv(a.raw())); }
+inline fix sqrt(fix a) { return fix::from_raw(sllsqrt(a.raw())); }
+inline fix rsqrt(fix a) { return fix::from_raw(sllrsqrt(a.raw())); }
+inline fix sin(fix a) { return fix::from_raw(sllsin(a.raw())); }
+inline fix cos(fix a) { return fix::from_raw(sllcos(a.raw())); }
+inline fix tan(fix a) { return fix::from_raw(slltan(a.raw())); }
+inline fix asin(fix a) { return fix::from_raw(sllasin(a.raw())); }
+inline fix acos(fix a) { return fix::from_raw(sllacos(a.raw())); }
+inline fix atan(fix a) { return fix::from_raw(sllatan(a.raw())); }
+inline fix atan2(fix y, fix x) { return fix::from_raw(sllatan2(y.raw(), x.raw())); }
+inline fix exp(fix a) { return fix::from_raw(sllexp(a.raw())); }
+inline fix log(fix a) { return fix::from_raw(slllog(a.raw())); }
+inline fix pow(fix a, fix b) { return fix::from_raw(sllpow(a.raw(), b.raw())); }
+
+namespace detail {
+
+/* Not constexpr, so reaching it while compiling a literal is an error */
+inline sll bad_fx_literal() { return CONST_0; }
+
+/*
+ * Decimal literal to sll
+ *
+ * Description
+ *
+ *	The integer part is accumulated as is.  The fraction, kept as its
+ *	decimal digits, is doubled 33 times; each carry out of the first digit
+ *	is the next binary digit, and the 33rd rounds the other 32.
+ */
+
+template <char... C>
+constexpr sll parse_fx()
+{
+	const char s[] = {C..., '\0'};
+	int frac[sizeof...(C) + 1] = {};
+	int n = 0;
+	int i = 0;
+	ull ip = 0;
+	ull fp = 0;
+
+	for (; s[i] != '\0' && s[i] != '.'; i++) {
+		if (s[i] == '\'')
+			continue;
+		if (s[i] < '0' || s[i] > '9')
+			return bad_fx_literal();
+		ip = ip * 10 + (ull) (s[i] - '0');
+		if (ip > 0x7fffffffULL)
+			return bad_fx_literal();
+	}
+	if (s[i] == '.') {
+		for (i++; s[i] != '\0'; i++) {
+			if (s[i] == '\'')
+				continue;
+			if (s[i] < '0' || s[i] > '9')
+				return bad_fx_literal();
+			frac[n++] = s[i] - '0';
+		}
+	}
+
+	for (int b = 0; b < 33; b++) {
+		int carry = 0;
+
+		for (int j = n - 1; j >= 0; j--) {
+			int d = frac[j] * 2 + carry;
+
+			frac[j] = d % 10;
+			carry = d / 10;
+		}
+		fp = (fp << 1) | (ull) carry;
+	}
+
+	fp = (ip << 32) + ((fp + 1) >> 1);
+	if (fp > 0x7fffffffffffffffULL)
+		return bad_fx_literal();
+
+	return (sll) fp;
+}
+
+} /* namespace detail */
+
+inline namespace literals {
+
+template <char... C>
+constexpr fix operator""_fx()
+{
+	return fix::from_raw(std::integral_constant<sll, detail::parse_fx<C...>()>::value);
+}
+
+} /* namespace literals */
+
+} /* namespace fixmath */
+
+#endif /* !defined(MATH_SLL_HPP) */
@@ -0,0 +1,55 @@
+/*
+ * Generate math-sll-sintab.h
+ *
+ * Description
+ *
+ *	Writes the quarter-wave sine table used by math-sll.c when it is built
+ *	with SLL_TRIG_TABLE.  Entry k holds sin (k * pi / 512), rounded to the
+ *	nearest sll, for 0 <= k <= 256.  cos (k * pi / 512) is entry 256 - k.
+ *
+ *	The table is the only part of the trigonometric engine that depends on
+ *	floating point, and it is computed once, here.  Everything evaluated at
+ *	run time is integer arithmetic, so results are bit-exact on every
+ *	platform.  Regenerate from the top of the tree with:
+ *
+ *	cc -o gen-sll-sintab tools/gen-sll-sintab.c -lm
+ *	./gen-sll-sintab > math-sll-sintab.h
+ *
+ *	Needs a long double with at least 64 significand bits (x86).
+ */
+
+#include <stdio.h>
+#include <math.h>
+
+#define SINTAB_SIZE	256
+
+/* pi * 2^55, which is pi / 512 in 0.64 format */
+#define SINTAB_STEP	0x01921fb54442d184ULL
+
+int main(void)
+{
+	const long double pi = 3.14159265358979323846264338327950288L;
+	int k;
+
+	printf("/*\n");
+	printf(" * Generated by tools/gen-sll-sintab.c - do not edit\n");
+	printf(" *\n");
+	printf(" * sin (k * pi / %d) for 0 <= k <= %d\n", 2 * SINTAB_SIZE, SINTAB_SIZE);
+	printf(" */\n\n");
+	printf("#if !defined(MATH_SLL_SINTAB_H)\n");
+	printf("#  define MATH_SLL_SINTAB_H\n\n");
+	printf("#define SLL_SINTAB_SIZE\t%d\n", SINTAB_SIZE);
+	printf("#define SLL_SINTAB_STEP\t0x%016llxULL\t// pi / %d, 0.64 format\n\n",
+		SINTAB_STEP, 2 * SINTAB_SIZE);
+	printf("static const sll sll_sintab[SLL_SINTAB_SIZE + 1] = {\n");
+	for (k = 0; k <= SINTAB_SIZE; k++) {
+		long double v = sinl(k * pi / (2 * SINTAB_SIZE));
+
+		printf("\t0x%016llxLL,\t// %3d\n",
+			(unsigned long long) llroundl(ldexpl(v, 32)), k);
+	}
+	printf("};\n\n");
+	printf("#endif /* !defined(MATH_SLL_SINTAB_H) */\n");
+
+	return 0;
+}